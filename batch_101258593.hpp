@@ -0,0 +1,309 @@
+/**
+ * @file batch_101258593.hpp
+ * @brief Batch mode: runs many (input file, policy) simulations on a thread pool
+ * @author 101258593
+ *
+ * Every job is an independent simulation with its own workload, memory,
+ * sinks and output file (output_files/execution_<POLICY>_<input>.txt by default), so
+ * jobs never share mutable state and run on all cores. The metrics of all
+ * jobs are merged into a single report once the pool has drained.
+ */
+
+#ifndef BATCH_101258593_HPP_
+#define BATCH_101258593_HPP_
+
+#include <charconv>
+#include <thread>
+#include <atomic>
+#include <glob.h>
+
+#include "simulator_101258593.hpp"
+
+const unsigned int MAX_JOBS = 1024;    // worker threads of --jobs
+
+//Parses a worker count, 1 to MAX_JOBS
+inline bool parse_jobs(const std::string &value, unsigned int &workers) {
+    const char *end = value.data() + value.size();
+    unsigned int parsed = 0;
+    auto [next, ec] = std::from_chars(value.data(), end, parsed);
+    if (ec != std::errc() || next != end || parsed < 1 || parsed > MAX_JOBS) return false;
+    workers = parsed;
+    return true;
+}
+
+//One (input, policy) simulation of a batch
+struct batch_job{
+    std::string     input;
+    std::string     policy;
+    std::string     output_name;       // empty with --format=none
+    sim_metrics     metrics;
+    memory_stats    memory;
+    std::string     error;             // empty if the job succeeded
+};
+
+//File name without its directory and extension ("input_files/test1.txt" -> "test1")
+inline std::string file_stem(const std::string &path) {
+    std::string name = path.substr(path.find_last_of('/') + 1);
+    std::size_t dot = name.find_last_of('.');
+    return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+//Appends the files matching `pattern` (a plain path or a shell glob, for
+//patterns the shell did not expand) to `inputs`
+inline bool expand_input(const std::string &pattern,
+                         std::vector<std::string> &inputs, std::string &error) {
+    if (pattern.find_first_of("*?[") == std::string::npos) {
+        inputs.push_back(pattern);
+        return true;
+    }
+
+    glob_t matches;
+    int status = glob(pattern.c_str(), 0, nullptr, &matches);
+    if (status == 0) {
+        for (std::size_t i = 0; i < matches.gl_pathc; i++) {
+            inputs.push_back(matches.gl_pathv[i]);
+        }
+    }
+    globfree(&matches);
+
+    if (status != 0) {
+        error = "No input file matches " + pattern;
+        return false;
+    }
+    return true;
+}
+
+//Splits "EP,RR" into its policies
+inline bool parse_policies(const std::string &list,
+                           std::vector<std::string> &policies, std::string &error) {
+    std::size_t start = 0;
+    while (start <= list.size()) {
+        std::size_t comma = std::min(list.find(',', start), list.size());
+        std::string policy = list.substr(start, comma - start);
+        if (!is_policy(policy)) {
+            error = "Unknown policy: " + policy;
+            return false;
+        }
+        policies.push_back(policy);
+        start = comma + 1;
+    }
+    return true;
+}
+
+//Settings shared by every job of a batch, read-only while the jobs run
+struct batch_options{
+    sim_options     simulation;
+    std::string     format = "table";  // table, bin or none
+    memory_config   memory;
+};
+
+//Runs one job; only touches its own batch_job, so it can run on any thread
+inline void run_batch_job(batch_job &job, const batch_options &options) {
+    pcb_table processes;
+    if (!load_workload(job.input.c_str(), processes, job.error)) return;
+
+    std::ofstream output_file;
+    std::unique_ptr<exec_sink> log;
+    if (options.format != "none") {
+        output_file.open(job.output_name, std::ios::binary);
+        if (!output_file.is_open()) {
+            job.error = "Error opening " + job.output_name;
+            return;
+        }
+        if (options.format == "bin") {
+            log.reset(new binary_sink(output_file, options.simulation.cpus > 1));
+        } else {
+            log.reset(new table_sink(output_file, options.simulation.cpus > 1));
+        }
+    }
+
+    metrics_sink sink(log.get(), options.simulation.cpus);
+    std::unique_ptr<memory_manager> memory = make_memory_manager(options.memory);
+    run_simulation(job.policy, processes, *memory, sink, options.simulation);
+    job.metrics = sink.result();
+    job.memory = memory->stats();
+}
+
+//Calls job(i) for every i < count on `workers` threads; each thread takes
+//the next i not yet started
+template <typename Job>
+void parallel_for(std::size_t count, unsigned int workers, Job job) {
+    std::atomic<std::size_t> next_job(0);
+    auto worker = [&]() {
+        for (std::size_t i = next_job++; i < count; i = next_job++) {
+            job(i);
+        }
+    };
+
+    workers = std::max(1u, std::min<unsigned int>(workers, count));
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < workers; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();                          // the calling thread is a worker too
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+}
+
+//Runs every job on `workers` threads
+inline void run_batch(std::vector<batch_job> &jobs, unsigned int workers,
+                      const batch_options &options) {
+    parallel_for(jobs.size(), workers, [&](std::size_t i) {
+        run_batch_job(jobs[i], options);
+    });
+}
+
+//Merged report, one row per successful job in input then policy order
+inline void print_batch_metrics(std::ostream &out, const std::vector<batch_job> &jobs) {
+    std::size_t name_width = 5;
+    for (const batch_job &job : jobs) {
+        name_width = std::max(name_width, job.input.size());
+    }
+
+    out << std::fixed << "\n===== Batch metrics (" << jobs.size() << " jobs) =====\n"
+        << std::left << std::setw(name_width) << "Input" << std::right
+        << " | Policy | Processes | Throughput | Avg Wait | Avg Turnaround | Avg Response\n";
+    for (const batch_job &job : jobs) {
+        if (!job.error.empty()) continue;
+        out << std::left << std::setw(name_width) << job.input << std::right
+            << " | " << std::setw(6) << job.policy
+            << " | " << std::setw(9) << job.metrics.processes
+            << " | " << std::setw(10) << std::setprecision(4) << job.metrics.throughput
+            << " | " << std::setw(8) << std::setprecision(2) << job.metrics.avg_wait_time
+            << " | " << std::setw(14) << job.metrics.avg_turnaround
+            << " | " << std::setw(12) << job.metrics.avg_response << "\n";
+    }
+    out.unsetf(std::ios::floatfield);
+    out << std::flush;
+}
+
+//Entry point of `--batch`: argv[1] is "--batch", the other arguments are
+//options and input files (or globs)
+inline int batch_main(int argc, char** argv) {
+
+    std::vector<std::string> inputs;
+    std::vector<std::string> policies;
+    unsigned int workers = std::thread::hardware_concurrency();
+    batch_options options;
+    std::string &format = options.format;
+    std::string metrics = "text";      // text, json or none
+    bool memory_stats = false;
+    std::string output_dir = "output_files";
+    std::string error;
+
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        bool ok = true;
+        if (option.rfind("--policy=", 0) == 0) {
+            ok = parse_policies(option.substr(9), policies, error);
+        } else if (option.rfind("--jobs=", 0) == 0) {
+            ok = parse_jobs(option.substr(7), workers);
+            if (!ok) error = "Invalid option: " + option;
+        } else if (option.rfind("--output-dir=", 0) == 0) {
+            output_dir = option.substr(13);
+        } else if (option.rfind("--config=", 0) == 0) {
+            ok = load_sim_config(option.c_str() + 9, options.simulation, error);
+        } else if (is_sim_option(option)) {
+            error = set_sim_option(option, options.simulation);
+            ok = error.empty();
+        } else if (option == "--format=table" || option == "--format=bin" ||
+                   option == "--format=none") {
+            format = option.substr(9);
+        } else if (option == "--metrics" || option == "--metrics=text") {
+            metrics = "text";
+        } else if (option == "--metrics=json" || option == "--metrics=none") {
+            metrics = option.substr(10);
+        } else if (option.rfind("--memory=", 0) == 0) {
+            ok = load_memory_config(option.c_str() + 9, options.memory, error);
+        } else if (option == "--memory-stats") {
+            memory_stats = true;
+        } else if (option.rfind("--", 0) == 0) {
+            ok = false;
+            error = "Unknown option: " + option;
+        } else {
+            ok = expand_input(option, inputs, error);
+        }
+        if (!ok) {
+            std::cerr << "Error: " << error << std::endl;
+            return -1;
+        }
+    }
+
+    if (inputs.empty()) {
+        std::string program = argv[0];
+        program = program.substr(program.find_last_of('/') + 1);
+        std::cout << "To run a batch, do: ./" << program
+                  << " --batch <input_file.txt|glob>... [--policy=EP,RR,EP_RR,MLFQ]"
+                     " [--jobs=N] [--output-dir=DIR] [--config=<run.conf>]"
+                     " [--engine=event|tick] [--cpus=N] [--quantum=MS]"
+                     " [--mlfq-quanta=Q0,Q1,...] [--mlfq-boost=MS] [--switch-cost=MS]"
+                     " [--scheduler-cost=MS] [--interrupt-cost=MS] [--stop=all|admitted]"
+                     " [--format=table|bin|none] [--metrics[=text|json|none]]"
+                     " [--memory=<config.txt>] [--memory-stats]"
+                  << std::endl;
+        return -1;
+    }
+    if (policies.empty()) {
+        policies = {"EP", "RR", "EP_RR"};
+    }
+
+    std::vector<batch_job> jobs;
+    for (const std::string &input : inputs) {
+        for (const std::string &policy : policies) {
+            batch_job job;
+            job.input = input;
+            job.policy = policy;
+            if (format != "none") {
+                job.output_name = output_dir + "/execution_" + policy + "_" +
+                                  file_stem(input) + (format == "bin" ? ".bin" : ".txt");
+            }
+            jobs.push_back(job);
+        }
+    }
+
+    // two inputs with the same name in different directories would share a log
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        for (std::size_t j = i + 1; j < jobs.size() && !jobs[i].output_name.empty(); j++) {
+            if (jobs[i].output_name == jobs[j].output_name) {
+                std::cerr << "Error: " << jobs[i].input << " and " << jobs[j].input
+                          << " would both write " << jobs[i].output_name << std::endl;
+                return -1;
+            }
+        }
+    }
+
+    run_batch(jobs, workers, options);
+
+    int status = 0;
+    for (const batch_job &job : jobs) {
+        if (!job.error.empty()) {
+            std::cerr << "Error: " << job.policy << ": " << job.error << std::endl;
+            status = -1;
+        } else if (!job.output_name.empty()) {
+            std::cout << "Output generated in " << job.output_name << std::endl;
+        }
+    }
+
+    if (metrics == "text") {
+        print_batch_metrics(std::cout, jobs);
+    } else if (metrics == "json") {
+        for (const batch_job &job : jobs) {
+            if (job.error.empty()) {
+                print_metrics_json(std::cout, job.input, job.metrics, job.policy);
+            }
+        }
+    }
+    if (memory_stats) {
+        for (const batch_job &job : jobs) {
+            if (job.error.empty()) {
+                print_memory_stats(std::cout, job.input + " (" + job.policy + ")",
+                                   options.memory.allocator, job.memory);
+            }
+        }
+    }
+
+    return status;
+}
+
+#endif  // BATCH_101258593_HPP_
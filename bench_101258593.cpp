@@ -0,0 +1,249 @@
+#include <chrono>
+#include <new>
+#include <cstdlib>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "generator_101258593.hpp"
+#include "simulator_101258593.hpp"
+
+// Heap allocations of this process, counted by the replaced operator new
+static unsigned long long allocation_count = 0;
+static unsigned long long allocated_bytes = 0;
+
+void *operator new(std::size_t size) {
+    allocation_count++;
+    allocated_bytes += size;
+    if (void *memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+// Kept out of line: once inlined next to a new-expression, GCC warns that
+// free() does not match new, although it matches this operator new
+__attribute__((noinline)) void operator delete(void *memory) noexcept { std::free(memory); }
+__attribute__((noinline)) void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+
+// Counts the transitions (the simulated events) and the terminations on
+// their way to the log
+class counting_sink : public exec_sink {
+public:
+    explicit counting_sink(exec_sink *next) : next(next) {}
+
+    void transition(unsigned int current_time, int PID,
+                    states old_state, states new_state,
+                    unsigned int cpu) override {
+        count++;
+        if (new_state == TERMINATED) terminated++;
+        if (next) next->transition(current_time, PID, old_state, new_state, cpu);
+    }
+
+    void finish() override {
+        if (next) next->finish();
+    }
+
+    unsigned long long count = 0;
+    unsigned long long terminated = 0;
+
+private:
+    exec_sink *next;
+};
+
+// Stream buffer that drops everything: logs are formatted but never written
+class null_buffer : public std::streambuf {
+protected:
+    std::streamsize xsputn(const char *, std::streamsize count) override { return count; }
+    int overflow(int c) override { return traits_type::not_eof(c); }
+};
+
+// Measurements of one run, sent back from the child process as raw bytes
+struct bench_result{
+    unsigned long long  events;
+    unsigned long long  terminated;     // processes that ran to the end
+    double              wall_ms;
+    long                peak_rss_kb;
+    unsigned long long  allocations;
+    unsigned long long  allocated_bytes;
+};
+
+// One simulation with the current process counters reset, from the copy
+// of the workload run_simulation takes to the footer of the log
+static bench_result measure(const pcb_table &processes, const std::string &policy,
+                            bool tick_engine, const std::string &format) {
+    null_buffer discard;
+    std::ostream log_stream(&discard);
+    std::unique_ptr<exec_sink> log;
+    if (format == "bin") {
+        log.reset(new binary_sink(log_stream));
+    } else if (format == "table") {
+        log.reset(new table_sink(log_stream));
+    }
+    counting_sink sink(log.get());
+    std::unique_ptr<memory_manager> memory = make_memory_manager(memory_config());
+
+    allocation_count = 0;
+    allocated_bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    sim_options options;
+    options.tick_engine = tick_engine;
+    run_simulation(policy, processes, *memory, sink, options);
+    auto stop = std::chrono::steady_clock::now();
+
+    bench_result result;
+    result.events = sink.count;
+    result.terminated = sink.terminated;
+    result.wall_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+    result.allocations = allocation_count;
+    result.allocated_bytes = allocated_bytes;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.peak_rss_kb = usage.ru_maxrss;
+    return result;
+}
+
+// Runs `measure` in a child process, so the peak RSS and allocation counts
+// of one run are not inflated by the runs before it
+static bool measure_isolated(const pcb_table &processes, const std::string &policy,
+                             bool tick_engine, const std::string &format,
+                             bench_result &result) {
+    int channel[2];
+    if (pipe(channel) != 0) return false;
+
+    pid_t child = fork();
+    if (child < 0) return false;
+    if (child == 0) {
+        close(channel[0]);
+        bench_result measured = measure(processes, policy, tick_engine, format);
+        ssize_t written = write(channel[1], &measured, sizeof(measured));
+        _exit(written == sizeof(measured) ? 0 : 1);
+    }
+
+    close(channel[1]);
+    ssize_t received = read(channel[0], &result, sizeof(result));
+    close(channel[0]);
+    int status = 0;
+    waitpid(child, &status, 0);
+    return received == sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Splits "a,b,c"
+static std::vector<std::string> split_list(const std::string &list) {
+    std::vector<std::string> items;
+    std::size_t start = 0;
+    while (start <= list.size()) {
+        std::size_t comma = std::min(list.find(',', start), list.size());
+        items.push_back(list.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return items;
+}
+
+int main(int argc, char** argv) {
+
+    std::vector<std::string> sizes = {"1000", "10000", "100000"};
+    std::vector<std::string> policies = {"EP", "RR", "EP_RR"};
+    std::vector<std::string> engines = {"event"};
+    std::vector<std::string> formats = {"none", "table"};
+    workload_params params;
+    std::string output_name = "output_files/benchmark_101258593.csv";
+
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        bool ok = true;
+        if (option.rfind("--sizes=", 0) == 0) {
+            sizes = split_list(option.substr(8));
+        } else if (option.rfind("--policy=", 0) == 0) {
+            policies = split_list(option.substr(9));
+            for (const std::string &policy : policies) ok = ok && is_policy(policy);
+        } else if (option.rfind("--engine=", 0) == 0) {
+            engines = split_list(option.substr(9));
+            for (const std::string &engine : engines)
+                ok = ok && (engine == "event" || engine == "tick");
+        } else if (option.rfind("--format=", 0) == 0) {
+            formats = split_list(option.substr(9));
+            for (const std::string &format : formats)
+                ok = ok && (format == "none" || format == "table" || format == "bin");
+        } else if (option.rfind("--seed=", 0) == 0) {
+            params.seed = std::strtoul(option.c_str() + 7, nullptr, 10);
+        } else if (option.rfind("--output=", 0) == 0) {
+            output_name = option.substr(9);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            std::cerr << "Error: Invalid argument: " << option << std::endl;
+            std::cout << "To run the benchmarks, do: ./bench_101258593"
+                         " [--sizes=1000,10000,100000] [--policy=EP,RR,EP_RR,MLFQ]"
+                         " [--engine=event,tick] [--format=none,table,bin]"
+                         " [--seed=N] [--output=<results.csv>]" << std::endl;
+            return -1;
+        }
+    }
+
+    std::ofstream csv(output_name);
+    if (!csv.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return -1;
+    }
+    csv << "policy,engine,format,processes,terminated,events,wall_ms,events_per_sec,"
+           "peak_rss_kb,allocations,allocated_bytes\n";
+
+    std::cout << std::left << std::setw(6) << "Policy" << std::right
+              << std::setw(7) << "Engine" << std::setw(7) << "Format"
+              << std::setw(10) << "Processes" << std::setw(11) << "Terminated"
+              << std::setw(12) << "Events"
+              << std::setw(12) << "Wall (ms)" << std::setw(14) << "Events/s"
+              << std::setw(14) << "Peak RSS (KB)" << std::setw(13) << "Allocations"
+              << std::endl;
+
+    for (const std::string &size : sizes) {
+        params.count = std::strtoul(size.c_str(), nullptr, 10);
+        pcb_table processes = generate_workload(params);
+
+        for (const std::string &policy : policies) {
+            for (const std::string &engine : engines) {
+                for (const std::string &format : formats) {
+                    bench_result result;
+                    if (!measure_isolated(processes, policy, engine == "tick",
+                                          format, result)) {
+                        std::cerr << "Error: " << policy << " run on " << size
+                                  << " processes failed" << std::endl;
+                        return -1;
+                    }
+                    // every generated process fits, a run that ends early
+                    // times less work and is not comparable with the others
+                    if (result.terminated != params.count) {
+                        std::cerr << "Warning: " << policy << " ran " << result.terminated
+                                  << " of " << params.count << " processes" << std::endl;
+                    }
+                    double per_second = result.wall_ms > 0
+                                      ? result.events / (result.wall_ms / 1000) : 0;
+
+                    csv << policy << "," << engine << "," << format << ","
+                        << params.count << "," << result.terminated << ","
+                        << result.events << ","
+                        << std::fixed << std::setprecision(3) << result.wall_ms << ","
+                        << std::setprecision(0) << per_second << ","
+                        << result.peak_rss_kb << "," << result.allocations << ","
+                        << result.allocated_bytes << "\n";
+
+                    std::cout << std::left << std::setw(6) << policy << std::right
+                              << std::setw(7) << engine << std::setw(7) << format
+                              << std::setw(10) << params.count
+                              << std::setw(11) << result.terminated
+                              << std::setw(12) << result.events
+                              << std::fixed << std::setprecision(1)
+                              << std::setw(12) << result.wall_ms
+                              << std::setprecision(0)
+                              << std::setw(14) << per_second
+                              << std::setw(14) << result.peak_rss_kb
+                              << std::setw(13) << result.allocations << std::endl;
+                }
+            }
+        }
+    }
+
+    std::cout << "Results written to " << output_name << std::endl;
+    return 0;
+}
@@ -7,17 +7,46 @@ else
     rm -f bin/*
 fi
 
+# helpers of interrupts_101258593.hpp, compiled once and linked into every binary
+g++ -g -O0 -std=c++17 -I . \
+    -c -o bin/interrupts_helpers_101258593.o \
+    interrupts_helpers_101258593.cpp
+
 # EP
 g++ -g -O0 -std=c++17 -I . \
     -o bin/interrupts_EP_101258593 \
-    interrupts_EP_101258593.cpp
+    interrupts_EP_101258593.cpp bin/interrupts_helpers_101258593.o
 
 # RR
 g++ -g -O0 -std=c++17 -I . \
     -o bin/interrupts_RR_101258593 \
-    interrupts_RR_101258593.cpp
+    interrupts_RR_101258593.cpp bin/interrupts_helpers_101258593.o
 
 # EP + RR
 g++ -g -O0 -std=c++17 -I . \
     -o bin/interrupts_EP_RR_101258593 \
-    interrupts_EP_RR_101258593.cpp
+    interrupts_EP_RR_101258593.cpp bin/interrupts_helpers_101258593.o
+
+# all policies, selected with --policy=EP|RR|EP_RR|MLFQ, --batch and --sweep modes
+g++ -g -O0 -std=c++17 -pthread -I . \
+    -o bin/interrupts_101258593 \
+    interrupts_101258593.cpp bin/interrupts_helpers_101258593.o
+
+# synthetic workload generator
+g++ -g -O0 -std=c++17 -I . \
+    -o bin/generator_101258593 \
+    generator_101258593.cpp bin/interrupts_helpers_101258593.o
+
+# benchmark suite; use the CMake Release build for meaningful timings
+g++ -g -O0 -std=c++17 -I . \
+    -o bin/bench_101258593 \
+    bench_101258593.cpp bin/interrupts_helpers_101258593.o
+
+# the simulator as a library (simulator_api_101258593.hpp), for programs that embed it
+g++ -g -O0 -std=c++17 -I . \
+    -c -o bin/simulator_api_101258593.o \
+    simulator_api_101258593.cpp
+ar rcs bin/libsimulator_101258593.a \
+    bin/simulator_api_101258593.o bin/interrupts_helpers_101258593.o
+
+rm -f bin/interrupts_helpers_101258593.o bin/simulator_api_101258593.o
@@ -0,0 +1,87 @@
+#include "generator_101258593.hpp"
+
+// Parses the value of a "--name=value" option
+template <typename T>
+static bool parse_value(const std::string &option, std::size_t prefix, T &value) {
+    const char *begin = option.data() + prefix;
+    const char *end = option.data() + option.size();
+    auto [next, ec] = std::from_chars(begin, end, value);
+    return ec == std::errc() && next == end && begin != end;
+}
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        std::cout << "To generate a workload, do: ./generator_101258593 <count>"
+                     " [--seed=N] [--arrival=poisson|uniform]"
+                     " [--mean-interarrival=MS] [--horizon=MS]"
+                     " [--burst=exponential|pareto|uniform] [--mean-burst=MS]"
+                     " [--pareto-alpha=A] [--max-burst=MS] [--io-bound=FRACTION]"
+                     " [--max-size=N] [--priorities=N] [--output=<file.txt>]" << std::endl;
+        return -1;
+    }
+
+    workload_params params;
+    std::string output_name;          // empty for standard output
+
+    std::string failed;               // first invalid argument
+    if (!parse_value(std::string(argv[1]), 0, params.count)) failed = argv[1];
+
+    for (int i = 2; i < argc && failed.empty(); i++) {
+        std::string option = argv[i];
+        bool ok = true;
+        if (option.rfind("--seed=", 0) == 0) {
+            ok = parse_value(option, 7, params.seed);
+        } else if (option.rfind("--arrival=", 0) == 0) {
+            params.arrival = option.substr(10);
+            ok = is_arrival_distribution(params.arrival);
+        } else if (option.rfind("--mean-interarrival=", 0) == 0) {
+            ok = parse_value(option, 20, params.mean_interarrival) &&
+                 params.mean_interarrival > 0;
+        } else if (option.rfind("--horizon=", 0) == 0) {
+            ok = parse_value(option, 10, params.horizon);
+        } else if (option.rfind("--burst=", 0) == 0) {
+            params.burst = option.substr(8);
+            ok = is_burst_distribution(params.burst);
+        } else if (option.rfind("--mean-burst=", 0) == 0) {
+            ok = parse_value(option, 13, params.mean_burst) && params.mean_burst > 0;
+        } else if (option.rfind("--pareto-alpha=", 0) == 0) {
+            ok = parse_value(option, 15, params.pareto_alpha) && params.pareto_alpha > 0;
+        } else if (option.rfind("--max-burst=", 0) == 0) {
+            ok = parse_value(option, 12, params.max_burst) && params.max_burst > 0;
+        } else if (option.rfind("--io-bound=", 0) == 0) {
+            ok = parse_value(option, 11, params.io_bound) &&
+                 params.io_bound >= 0 && params.io_bound <= 1;
+        } else if (option.rfind("--max-size=", 0) == 0) {
+            ok = parse_value(option, 11, params.max_size) && params.max_size > 0;
+        } else if (option.rfind("--priorities=", 0) == 0) {
+            ok = parse_value(option, 13, params.priorities);
+        } else if (option.rfind("--output=", 0) == 0) {
+            output_name = option.substr(9);
+        } else {
+            ok = false;
+        }
+        if (!ok) failed = option;
+    }
+    if (!failed.empty()) {
+        std::cerr << "Error: Invalid argument: " << failed << std::endl;
+        return -1;
+    }
+
+    if (output_name.empty()) {
+        write_workload(std::cout, params);
+        return 0;
+    }
+
+    std::ofstream output_file(output_name, std::ios::binary);
+    if (!output_file.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return -1;
+    }
+    write_workload(output_file, params);
+    output_file.close();
+    std::cout << "Generated " << params.count << " processes in "
+              << output_name << std::endl;
+
+    return 0;
+}
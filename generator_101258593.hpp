@@ -0,0 +1,160 @@
+/**
+ * @file generator_101258593.hpp
+ * @brief Synthetic workloads in the input file format, for stress tests and benchmarks
+ * @author 101258593
+ *
+ * Processes are drawn one at a time from a seeded std::mt19937_64, so a
+ * (parameters, seed) pair always gives the same trace with the same
+ * standard library and traces of 10^7 processes stream to disk in constant
+ * memory.
+ */
+
+#ifndef GENERATOR_101258593_HPP_
+#define GENERATOR_101258593_HPP_
+
+#include <cmath>
+
+#include "interrupts_101258593.hpp"
+
+//Shape of a generated workload
+struct workload_params{
+    unsigned long   count = 1000;              // processes to generate
+    unsigned long   seed = 1;
+    std::string     arrival = "poisson";       // poisson or uniform
+    double          mean_interarrival = 20;    // ms between arrivals (poisson)
+    unsigned int    horizon = 0;               // uniform: last arrival, 0 = count * mean_interarrival
+    std::string     burst = "exponential";     // exponential, pareto (heavy tail) or uniform
+    double          mean_burst = 200;          // ms of CPU per process
+    double          pareto_alpha = 1.5;        // pareto: tail index, smaller = heavier
+    unsigned int    max_burst = 1000000;       // bursts are clamped to [1, max_burst]
+    double          io_bound = 0.3;            // fraction of I/O-bound processes
+    unsigned int    max_size = 40;             // sizes are uniform in [1, max_size]
+    unsigned int    priorities = 0;            // priorities uniform in [0, priorities), 0 = PID
+};
+
+inline bool is_arrival_distribution(const std::string &name) {
+    return name == "poisson" || name == "uniform";
+}
+
+inline bool is_burst_distribution(const std::string &name) {
+    return name == "exponential" || name == "pareto" || name == "uniform";
+}
+
+//Draws the processes of a workload in PID order (PIDs 1, 2, ...).
+//I/O-bound processes request short I/O often; CPU-bound ones rarely or never
+class workload_generator {
+public:
+    explicit workload_generator(const workload_params &params)
+        : params(params), random(params.seed) {}
+
+    bool done() const { return generated == params.count; }
+
+    process_record next() {
+        generated++;
+
+        unsigned int arrival;
+        if (params.arrival == "uniform") {
+            unsigned int horizon = params.horizon ? params.horizon
+                                 : clamp(params.count * params.mean_interarrival, 0, UINT32_MAX);
+            arrival = std::uniform_int_distribution<unsigned int>(0, horizon)(random);
+        } else {
+            clock += std::exponential_distribution<double>(1.0 / params.mean_interarrival)(random);
+            arrival = clamp(clock, 0, UINT32_MAX);
+        }
+
+        unsigned int size = std::uniform_int_distribution<unsigned int>(
+                                1, std::max(params.max_size, 1u))(random);
+        unsigned int burst = draw_burst();
+
+        unsigned int io_freq = 0, io_duration = 0;
+        if (unit(random) < params.io_bound) {
+            io_freq = uniform(5, 50);
+            io_duration = uniform(20, 200);
+        } else if (unit(random) < 0.5) {
+            io_freq = uniform(200, 1000);
+            io_duration = uniform(5, 50);
+        }
+
+        process_record process = add_process(int(std::min<unsigned long>(generated, INT32_MAX)),
+                                             size, arrival, burst, io_freq, io_duration);
+        if (params.priorities > 0) {
+            process.pcb.priority = int(std::min(uniform(0, params.priorities - 1),
+                                                unsigned(INT32_MAX)));
+        }
+        return process;
+    }
+
+private:
+    unsigned int draw_burst() {
+        double burst;
+        if (params.burst == "pareto") {
+            // scale chosen so the untruncated mean is mean_burst (alpha > 1)
+            double alpha = params.pareto_alpha;
+            double scale = alpha > 1 ? params.mean_burst * (alpha - 1) / alpha
+                                     : params.mean_burst;
+            burst = scale / std::pow(1.0 - unit(random), 1.0 / alpha);
+        } else if (params.burst == "uniform") {
+            burst = std::uniform_real_distribution<double>(1, 2 * params.mean_burst)(random);
+        } else {
+            burst = std::exponential_distribution<double>(1.0 / params.mean_burst)(random);
+        }
+        return clamp(std::ceil(burst), 1, params.max_burst);
+    }
+
+    unsigned int uniform(unsigned int low, unsigned int high) {
+        return std::uniform_int_distribution<unsigned int>(low, high)(random);
+    }
+
+    static unsigned int clamp(double value, double low, double high) {
+        return static_cast<unsigned int>(std::min(std::max(value, low), high));
+    }
+
+    workload_params                         params;
+    std::mt19937_64                         random;
+    std::uniform_real_distribution<double>  unit{0.0, 1.0};
+    unsigned long                           generated = 0;
+    double                                  clock = 0;      // poisson arrival time
+};
+
+//The whole workload in memory, for in-process runs
+inline pcb_table generate_workload(const workload_params &params) {
+    pcb_table processes;
+    processes.reserve(params.count);
+    workload_generator generator(params);
+    while (!generator.done()) {
+        processes.push_back(generator.next());
+    }
+    return processes;
+}
+
+//Writes one process as an input line, "PID, size, arrival, burst, io_freq,
+//io_duration", and the priority when it is not the PID
+inline void write_process_line(output_buffer &out, const process_record &process) {
+    char line[192];                    // 7 fields of up to 20 digits and their separators
+    char *pos = line;
+    const PCB &pcb = process.pcb;
+    const pcb_info &info = process.info;
+    const unsigned long long fields[] = {
+        static_cast<unsigned long long>(pcb.PID), info.size, info.arrival_time,
+        info.processing_time, info.io_freq, info.io_duration,
+        static_cast<unsigned long long>(pcb.priority)
+    };
+    std::size_t field_count = pcb.priority == pcb.PID ? 6 : 7;
+    for (std::size_t i = 0; i < field_count; i++) {
+        if (i > 0) { *pos++ = ','; *pos++ = ' '; }
+        pos = std::to_chars(pos, line + sizeof(line), fields[i]).ptr;
+    }
+    *pos++ = '\n';
+    out.write(line, pos - line);
+}
+
+//Streams a workload to `out` without holding it in memory
+inline void write_workload(std::ostream &out, const workload_params &params) {
+    output_buffer buffer(out);
+    workload_generator generator(params);
+    while (!generator.done()) {
+        write_process_line(buffer, generator.next());
+    }
+}
+
+#endif  // GENERATOR_101258593_HPP_
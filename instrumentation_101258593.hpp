@@ -0,0 +1,101 @@
+/**
+ * @file instrumentation_101258593.hpp
+ * @brief Optional hot-path counters and per-phase timing of a simulation run
+ * @author 101258593
+ *
+ * Compiled in only with -DSIM_INSTRUMENTATION=1 (cmake -DENABLE_INSTRUMENTATION=ON).
+ * Otherwise profile_count is an empty inline function and phase_timer an
+ * empty class, so the engines compile to the same code as without them.
+ * Each thread has its own profile, reset when a run starts, so batch jobs
+ * never share counters.
+ */
+
+#ifndef INSTRUMENTATION_101258593_HPP_
+#define INSTRUMENTATION_101258593_HPP_
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+#ifndef SIM_INSTRUMENTATION
+#define SIM_INSTRUMENTATION 0
+#endif
+
+//Events counted during a run
+enum profile_counter {
+    CONTEXT_SWITCHES,       // READY -> RUNNING dispatches
+    PRIORITY_PREEMPTIONS,   // running process preempted by a higher priority one
+    QUANTUM_PREEMPTIONS,    // running process used up its time quantum
+    IO_REQUESTS,            // RUNNING -> WAITING
+    ADMISSION_FAILURES,     // admission attempts turned down by memory
+    ENGINE_STEPS,           // loop iterations: event times or 1 ms ticks
+    PROFILE_COUNTERS
+};
+
+//Parts of a run timed separately. OUTPUT is the time spent in the log sink,
+//which is called from inside the other phases and is included in them
+enum profile_phase {
+    ADMISSION_PHASE,        // admit_processes
+    WAIT_QUEUE_PHASE,       // manage_wait_queue
+    CPU_PHASE,              // execute_cpu
+    DISPATCH_PHASE,         // dispatch
+    OUTPUT_PHASE,           // formatting and writing the transitions
+    RUN_PHASE,              // the whole run, from the copy of the PCB table to the footer
+    PROFILE_PHASES
+};
+
+struct sim_profile{
+    unsigned long long  counters[PROFILE_COUNTERS] = {};
+    long long           phase_ns[PROFILE_PHASES] = {};      // cumulative, steady clock
+};
+
+//Profile of the run on the calling thread
+inline sim_profile &current_profile() {
+    static thread_local sim_profile profile;
+    return profile;
+}
+
+inline void reset_profile() {
+    if (SIM_INSTRUMENTATION) current_profile() = sim_profile();
+}
+
+inline void profile_count(profile_counter counter, unsigned long long count = 1) {
+    if (SIM_INSTRUMENTATION) current_profile().counters[counter] += count;
+}
+
+//Adds the lifetime of the timer to a phase
+template <bool Enabled>
+class basic_phase_timer {
+public:
+    explicit basic_phase_timer(profile_phase phase)
+        : phase(phase), start(std::chrono::steady_clock::now()) {}
+
+    ~basic_phase_timer() {
+        current_profile().phase_ns[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    basic_phase_timer(const basic_phase_timer &) = delete;
+    basic_phase_timer &operator=(const basic_phase_timer &) = delete;
+
+private:
+    profile_phase                           phase;
+    std::chrono::steady_clock::time_point   start;
+};
+
+template <>
+class basic_phase_timer<false> {
+public:
+    explicit basic_phase_timer(profile_phase) {}
+};
+
+typedef basic_phase_timer<SIM_INSTRUMENTATION != 0> phase_timer;
+
+//Prints the profile of a run, as text or as one JSON object
+void print_profile(std::ostream &out, const std::string &name,
+                   const std::string &policy, const sim_profile &profile);
+
+void print_profile_json(std::ostream &out, const std::string &name,
+                        const std::string &policy, const sim_profile &profile);
+
+#endif  // INSTRUMENTATION_101258593_HPP_
@@ -0,0 +1,13 @@
+#include "sweep_101258593.hpp"
+
+// Simulator with the scheduling policy chosen by --policy=EP|RR|EP_RR|MLFQ,
+// a batch of simulations with --batch, or a parameter sweep with --sweep
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        return batch_main(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--sweep") {
+        return sweep_main(argc, argv);
+    }
+    return simulator_main(argc, argv, nullptr);
+}
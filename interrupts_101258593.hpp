@@ -17,11 +17,19 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <climits>
+
+#include "memory_101258593.hpp"
+#include "instrumentation_101258593.hpp"
 
 //------------------------------------ STATES ---------------------------------
 
 //An enumeration of states to make assignment easier
-enum states {
+enum states : std::uint8_t {
     NEW,
     READY,
     RUNNING,
@@ -30,314 +38,1281 @@ enum states {
     NOT_ASSIGNED
 };
 
-std::ostream& operator<<(std::ostream& os, const enum states& s) { //Overloading the << operator to make printing of the enum easier
-
-    std::string state_names[] = {
-        "NEW",
-        "READY",
-        "RUNNING",
-        "WAITING",
-        "TERMINATED",
-        "NOT_ASSIGNED"
-    };
-    return (os << state_names[s]);
-}
-
-//--------------------------------- MEMORY ------------------------------------
-
-struct memory_partition{
-    unsigned int    partition_number;
-    unsigned int    size;
-    int             occupied;          // PID of process, or -1 if free
-} memory_paritions[] = {
-    {1, 40, -1},
-    {2, 25, -1},
-    {3, 15, -1},
-    {4, 10, -1},
-    {5, 8, -1},
-    {6, 2, -1}
+constexpr const char *state_names[] = {
+    "NEW",
+    "READY",
+    "RUNNING",
+    "WAITING",
+    "TERMINATED",
+    "NOT_ASSIGNED"
 };
 
+//Overloading the << operator to make printing of the enum easier
+std::ostream& operator<<(std::ostream& os, const enum states& s);
+
 //---------------------------------- PCB --------------------------------------
 
+//The part of a process the engines touch at every step: the running
+//process's countdowns, and what the ready queues and sinks read. Kept small
+//(36 bytes, `state` in one byte) so the PCBs of many live processes stay in
+//cache; what only admission, memory and dispatch need is in pcb_info
 struct PCB{
     int             PID;
+    unsigned int    remaining_time;
+    unsigned int    cpu_since_last_io;   // CPU time since last I/O
+    unsigned int    io_freq;             // 0 if the process never does I/O (no I/O duration)
+    unsigned int    io_remaining;        // length of the pending I/O while WAITING
+    unsigned int    time_in_quantum;     // time used in current RR quantum
+    int             priority;            // external priority (smaller = higher)
+    unsigned int    level_boosts;        // MLFQ priority boosts done when `level` was set
+    std::int16_t    cpu;                 // core whose queue or CPU it was last on, -1 if none
+    std::uint8_t    level;               // MLFQ queue level (0 = highest)
+    enum states     state;
+};
+
+//The rest of a process: its input line and where it is in memory
+struct pcb_info{
     unsigned int    size;
     unsigned int    arrival_time;
-    int             start_time;
     unsigned int    processing_time;
-    unsigned int    remaining_time;
-    int             partition_number;
-    enum states     state;
-    unsigned int    io_freq;
+    unsigned int    io_freq;             // as given in the input
     unsigned int    io_duration;
+    int             start_time;
+    int             partition_number;
+    int             memory_slot;         // memory manager handle of the memory held, -1 if none
+};
 
-    // ---- Extra fields for scheduling / I/O ----
-    unsigned int    cpu_since_last_io;   // CPU time since last I/O
-    unsigned int    io_remaining;        // remaining I/O time while WAITING
-    unsigned int    time_in_quantum;     // time used in current RR quantum
-    int             priority;            // external priority (smaller = higher)
+//One process as read from an input line (see add_process)
+struct process_record{
+    PCB             pcb;
+    pcb_info        info;
 };
 
-//--------------------------------- HELPERS -----------------------------------
+typedef std::uint32_t pcb_handle;
+
+//The PCB table is the single authoritative copy of every process. Queues and
+//the CPU refer to processes by their slot in the table, which indexes both
+//the PCBs and their pcb_info
+struct pcb_table{
+    std::vector<PCB>        pcbs;
+    std::vector<pcb_info>   infos;
 
-// Following function was taken from stackoverflow; helper function for splitting strings
-inline std::vector<std::string> split_delim(std::string input, std::string delim) {
-    std::vector<std::string> tokens;
-    std::size_t pos = 0;
-    std::string token;
-    while ((pos = input.find(delim)) != std::string::npos) {
-        token = input.substr(0, pos);
-        tokens.push_back(token);
-        input.erase(0, pos + delim.length());
+    PCB &operator[](pcb_handle handle) { return pcbs[handle]; }
+    const PCB &operator[](pcb_handle handle) const { return pcbs[handle]; }
+    pcb_info &info(pcb_handle handle) { return infos[handle]; }
+    const pcb_info &info(pcb_handle handle) const { return infos[handle]; }
+
+    std::size_t size() const { return pcbs.size(); }
+    bool empty() const { return pcbs.empty(); }
+
+    void reserve(std::size_t count) {
+        pcbs.reserve(count);
+        infos.reserve(count);
     }
-    tokens.push_back(input);
 
-    return tokens;
-}
+    void push_back(const process_record &process) {
+        pcbs.push_back(process.pcb);
+        infos.push_back(process.info);
+    }
 
-//Function that takes a queue as an input and outputs a string table of PCBs
-inline std::string print_PCB(std::vector<PCB> _PCB) {
-    const int tableWidth = 83;
-
-    std::stringstream buffer;
-    
-    // Print top border
-    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
-    
-    // Print headers
-    buffer << "|"
-           << std::setfill(' ') << std::setw(4) << "PID"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(11) << "Partition"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(5) << "Size"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(13) << "Arrival Time"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(11) << "Start Time"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(14) << "Remaining Time"
-           << std::setw(2) << "|"
-           << std::setfill(' ') << std::setw(11) << "State"
-           << std::setw(2) << "|" << std::endl;
-    
-    // Print separator
-    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
-    
-    // Print each PCB entry
-    for (const auto& program : _PCB) {
-        buffer << "|"
-               << std::setfill(' ') << std::setw(4) << program.PID
-               << std::setw(2) << "|"
-               << std::setw(11) << program.partition_number
-               << std::setw(2) << "|"
-               << std::setw(5) << program.size
-               << std::setw(2) << "|"
-               << std::setw(13) << program.arrival_time
-               << std::setw(2) << "|"
-               << std::setw(11) << program.start_time
-               << std::setw(2) << "|"
-               << std::setw(14) << program.remaining_time
-               << std::setw(2) << "|"
-               << std::setw(11) << program.state
-               << std::setw(2) << "|" << std::endl;
-    }
-    
-    // Print bottom border
-    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
-
-    return buffer.str();
-}
+    void set(pcb_handle handle, const process_record &process) {
+        pcbs[handle] = process.pcb;
+        infos[handle] = process.info;
+    }
 
-//Overloaded function that takes a single PCB as input
-inline std::string print_PCB(PCB _PCB) {
-    std::vector<PCB> temp;
-    temp.push_back(_PCB);
-    return print_PCB(temp);
-}
+    process_record record(pcb_handle handle) const { return {pcbs[handle], infos[handle]}; }
+
+    void save(snapshot_writer &out) const {
+        out.put(pcbs);
+        out.put(infos);
+    }
+    void restore(snapshot_reader &in) {
+        std::size_t count = size();
+        in.get(pcbs);
+        in.get(infos);
+        if (pcbs.size() != count || infos.size() != count) {
+            in.fail();
+            pcbs.resize(count);
+            infos.resize(count);
+        }
+    }
+};
+
+
+const pcb_handle NO_PROCESS = UINT32_MAX;   // idle CPU / no process
+
+//--------------------------------- EVENTS ------------------------------------
+
+//Kinds of events handled by the discrete-event engine
+enum event_type {
+    ARRIVAL,            // a process arrives (or memory was freed and admission is retried)
+    IO_COMPLETION,      // a WAITING process finishes its I/O
+    IO_REQUEST,         // the running process issues an I/O request
+    TERMINATION,        // the running process finishes its CPU burst
+    QUANTUM_EXPIRY,     // the running process used up its time quantum
+    PRIORITY_BOOST      // the policy moves every process back to its top level
+};
 
-inline std::string print_exec_header() {
-
-    const int tableWidth = 49;
-
-    std::stringstream buffer;
-    
-    // Print top border
-    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
-    
-    // Print headers
-    buffer  << "|"
-            << std::setfill(' ') << std::setw(18) << "Time of Transition"
-            << std::setw(2) << "|"
-            << std::setfill(' ') << std::setw(3) << "PID"
-            << std::setw(2) << "|"
-            << std::setfill(' ') << std::setw(10) << "Old State"
-            << std::setw(2) << "|"
-            << std::setfill(' ') << std::setw(10) << "New State"
-            << std::setw(2) << "|" << std::endl;
-    
-    // Print separator
-    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
-
-    return buffer.str();
+struct sim_event{
+    unsigned int    time;
+    enum event_type type;
+    pcb_handle      handle;            // process the event is about, or NO_PROCESS
+    unsigned long   seq;               // insertion order, keeps equal events FIFO
+};
 
+//Events at the same time are handled in the same order as the phases of a tick:
+//priority boost and admission, then I/O completion, then the CPU step
+inline int event_phase(enum event_type type) {
+    if (type == ARRIVAL || type == PRIORITY_BOOST) return 0;
+    if (type == IO_COMPLETION) return 1;
+    return 2;
 }
 
-inline std::string print_exec_status(unsigned int current_time, int PID, states old_state, states new_state) {
+struct sim_event_later{
+    bool operator()(const sim_event &a, const sim_event &b) const {
+        if (a.time != b.time) return a.time > b.time;
+        if (event_phase(a.type) != event_phase(b.type))
+            return event_phase(a.type) > event_phase(b.type);
+        return a.seq > b.seq;
+    }
+};
 
-    const int tableWidth = 49;
+//Time-ordered event queue, a binary heap
+struct event_queue{
+    std::vector<sim_event> heap;
+    unsigned long next_seq = 0;
 
-    std::stringstream buffer;
+    void push(unsigned int time, enum event_type type, pcb_handle handle) {
+        heap.push_back({time, type, handle, next_seq++});
+        std::push_heap(heap.begin(), heap.end(), sim_event_later());
+    }
+    bool empty() const { return heap.empty(); }
+    const sim_event &top() const { return heap.front(); }
+    void pop() {
+        std::pop_heap(heap.begin(), heap.end(), sim_event_later());
+        heap.pop_back();
+    }
 
-    buffer  << "|"
-            << std::setfill(' ') << std::setw(18) << current_time
-            << std::setw(2) << "|"
-            << std::setw(3) << PID
-            << std::setw(2) << "|"
-            << std::setw(10) << old_state
-            << std::setw(2) << "|"
-            << std::setw(10) << new_state
-            << std::setw(2) << "|" << std::endl;
+    //True if the next event happens at `time` and belongs to the phase of `type`
+    bool due(unsigned int time, enum event_type type) const {
+        return !heap.empty() && heap.front().time == time &&
+               event_phase(heap.front().type) == event_phase(type);
+    }
 
-    return buffer.str();
-}
+    void save(snapshot_writer &out) const { out.put(heap); out.put(next_seq); }
+    void restore(snapshot_reader &in) { in.get(heap); in.get(next_seq); }
+};
 
-inline std::string print_exec_footer() {
-    const int tableWidth = 49;
-    std::stringstream buffer;
+//------------------------------- READY QUEUES --------------------------------
 
-    // Print bottom border
-    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+//Both ready queues hold PCB handles and share the same interface (push, pop,
+//front, empty, size), so the helpers below work with either one
 
-    return buffer.str();
-}
+//FIFO ready queue backed by a ring buffer: O(1) push and pop (RR)
+struct fifo_ready_queue{
+    std::vector<pcb_handle> buffer;    // capacity is always a power of two
+    std::size_t             head = 0;
+    std::size_t             count = 0;
 
-//Synchronize the process in the process queue
-inline void sync_queue(std::vector<PCB> &process_queue, PCB _process) {
-    for(auto &process : process_queue) {
-        if(process.PID == _process.PID) {
-            process = _process;
+    fifo_ready_queue() = default;
+    //Takes the PCB table like priority_ready_queue so engines build either one
+    //the same way; the order of a FIFO does not depend on the PCBs
+    explicit fifo_ready_queue(const pcb_table &) {}
+
+    void push(pcb_handle handle) {
+        if (count == buffer.size()) grow();
+        buffer[(head + count) & (buffer.size() - 1)] = handle;
+        count++;
+    }
+
+    pcb_handle pop() {
+        pcb_handle handle = buffer[head];
+        head = (head + 1) & (buffer.size() - 1);
+        count--;
+        return handle;
+    }
+
+    pcb_handle front() const { return buffer[head]; }
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    void save(snapshot_writer &out) const {
+        out.put(buffer);
+        out.put(head);
+        out.put(count);
+    }
+    void restore(snapshot_reader &in) {
+        in.get(buffer);
+        in.get(head);
+        in.get(count);
+        if (count > buffer.size() || (buffer.size() & (buffer.size() - 1))) in.fail();
+    }
+
+    //Double the capacity, unrolling the ring so the front is at index 0
+    void grow() {
+        std::vector<pcb_handle> larger(buffer.empty() ? 16 : buffer.size() * 2);
+        for (std::size_t i = 0; i < count; i++) {
+            larger[i] = buffer[(head + i) & (buffer.size() - 1)];
         }
+        buffer.swap(larger);
+        head = 0;
     }
+};
+
+//Heap entry; the sort key is copied from the PCB so sifting stays in the heap
+struct ready_entry{
+    int             priority;
+    int             PID;
+    pcb_handle      handle;
+};
+
+//True if a should be dispatched after b: smaller priority value first, then smaller PID
+inline bool lower_priority(const ready_entry &a, const ready_entry &b) {
+    if (a.priority != b.priority) return a.priority > b.priority;
+    return a.PID > b.PID;
 }
 
-//Writes a string to a file
-inline void write_output(const std::string &execution, const char* filename) {
-    std::ofstream output_file(filename);
+//Ready queue backed by a binary heap on (priority, PID): O(log n) push and pop (EP, EP_RR)
+struct priority_ready_queue{
+    const pcb_table         &processes;
+    std::vector<ready_entry> heap;
 
-    if (output_file.is_open()) {
-        output_file << execution;
-        output_file.close();
-        std::cout << "File content overwritten successfully." << std::endl;
-    } else {
-        std::cerr << "Error opening file!" << std::endl;
+    explicit priority_ready_queue(const pcb_table &table) : processes(table) {}
+
+    void push(pcb_handle handle) {
+        heap.push_back({processes[handle].priority, processes[handle].PID, handle});
+        std::push_heap(heap.begin(), heap.end(), lower_priority);
+    }
+
+    pcb_handle pop() {
+        std::pop_heap(heap.begin(), heap.end(), lower_priority);
+        pcb_handle handle = heap.back().handle;
+        heap.pop_back();
+        return handle;
     }
 
-    std::cout << "Output generated in " << filename << std::endl;
+    pcb_handle front() const { return heap.front().handle; }
+    int front_priority() const { return heap.front().priority; }   // O(1) minimum
+    bool empty() const { return heap.empty(); }
+    std::size_t size() const { return heap.size(); }
+
+    void save(snapshot_writer &out) const { out.put(heap); }
+    void restore(snapshot_reader &in) { in.get(heap); }
+};
+
+//-------------------------------- WAIT QUEUE ---------------------------------
+
+//Waiting processes keyed by the absolute time their I/O completes, in a
+//timing wheel. The I/O completing within WAIT_WHEEL_SLOTS ms of the last
+//completion wait in one contiguous bucket per ms, in the order they started
+//waiting; the others wait in a min-heap on (completion time, insertion
+//order) until they come within range. A bitmask of the occupied buckets
+//finds the next completion a word at a time, so push and pop are O(1) for
+//the usual short I/O however many processes wait, and equal-time
+//completions still leave in the order they started waiting
+struct wait_entry{
+    unsigned int    completion_time;
+    unsigned long   seq;
+    pcb_handle      handle;
+};
+
+inline bool completes_later(const wait_entry &a, const wait_entry &b) {
+    if (a.completion_time != b.completion_time)
+        return a.completion_time > b.completion_time;
+    return a.seq > b.seq;
 }
 
-//--------------------------------- "OS" FUNCTIONS -----------------------------
+const std::size_t WAIT_WHEEL_SLOTS = 4096;     // ms covered by the wheel, a power of two
+
+struct io_wait_queue{
+    std::vector<std::vector<pcb_handle>> buckets;  // by completion time % WAIT_WHEEL_SLOTS
+    std::vector<std::uint64_t>  occupied;          // one bit per non-empty bucket
+    std::size_t                 head = 0;          // processes popped from the next bucket
+    unsigned int                cursor = 0;        // the wheel holds [cursor, cursor + slots)
+    unsigned int                next_time = 0;     // earliest completion, while not empty
+    std::size_t                 count = 0;
+    std::vector<wait_entry>     later;             // beyond the wheel, a min-heap
+    unsigned long               next_seq = 0;
+
+    io_wait_queue() : buckets(WAIT_WHEEL_SLOTS), occupied(WAIT_WHEEL_SLOTS / 64, 0) {}
+
+    //Completions are never earlier than the last one popped
+    void push(pcb_handle handle, unsigned int completion_time) {
+        if (count == 0 || completion_time < next_time) next_time = completion_time;
+        count++;
+        if (in_wheel(completion_time)) {
+            add(handle, completion_time);
+        } else {
+            later.push_back({completion_time, next_seq++, handle});
+            std::push_heap(later.begin(), later.end(), completes_later);
+        }
+    }
+
+    pcb_handle pop() {
+        cursor = next_time;
+        // the I/O that came within range of the wheel leave the heap, in order
+        while (!later.empty() && in_wheel(later.front().completion_time)) {
+            add(later.front().handle, later.front().completion_time);
+            std::pop_heap(later.begin(), later.end(), completes_later);
+            later.pop_back();
+        }
+
+        std::size_t slot = cursor & (WAIT_WHEEL_SLOTS - 1);
+        std::vector<pcb_handle> &bucket = buckets[slot];
+        pcb_handle handle = bucket[head++];
+        count--;
+        if (head == bucket.size()) {
+            bucket.clear();
+            head = 0;
+            occupied[slot / 64] &= ~(std::uint64_t(1) << (slot % 64));
+            if (count > 0) next_time = earliest();
+        }
+        return handle;
+    }
+
+    //True if the earliest I/O completes at or before `time`
+    bool due(unsigned int time) const {
+        return count > 0 && next_time <= time;
+    }
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    void save(snapshot_writer &out) const {
+        out.put(head);
+        out.put(cursor);
+        out.put(next_time);
+        out.put(count);
+        out.put(later);
+        out.put(next_seq);
+        for (const std::vector<pcb_handle> &bucket : buckets) out.put(bucket);
+    }
+    void restore(snapshot_reader &in) {
+        in.get(head);
+        in.get(cursor);
+        in.get(next_time);
+        in.get(count);
+        in.get(later);
+        in.get(next_seq);
+        std::size_t waiting = later.size();
+        for (std::size_t slot = 0; slot < WAIT_WHEEL_SLOTS; slot++) {
+            in.get(buckets[slot]);
+            waiting += buckets[slot].size();
+            std::uint64_t bit = std::uint64_t(1) << (slot % 64);
+            occupied[slot / 64] = buckets[slot].empty() ? occupied[slot / 64] & ~bit
+                                                        : occupied[slot / 64] | bit;
+        }
+        if (waiting != count + head) in.fail();
+    }
+
+private:
+    bool in_wheel(unsigned int time) const {
+        return std::uint64_t(time) < std::uint64_t(cursor) + WAIT_WHEEL_SLOTS;
+    }
+
+    void add(pcb_handle handle, unsigned int time) {
+        std::size_t slot = time & (WAIT_WHEEL_SLOTS - 1);
+        buckets[slot].push_back(handle);
+        occupied[slot / 64] |= std::uint64_t(1) << (slot % 64);
+    }
+
+    //Earliest completion of a non-empty queue: the first occupied bucket
+    //from the cursor on, wrapping around, or else the heap's
+    unsigned int earliest() const {
+        const std::size_t words = WAIT_WHEEL_SLOTS / 64;
+        std::size_t start = cursor & (WAIT_WHEEL_SLOTS - 1);
+        for (std::size_t i = 0; i <= words; i++) {
+            std::size_t word = (start / 64 + i) % words;
+            std::uint64_t bits = occupied[word];
+            if (i == 0) bits &= ~std::uint64_t(0) << (start % 64);
+            if (i == words) bits &= ~(~std::uint64_t(0) << (start % 64));
+            if (bits) {
+                std::size_t slot = word * 64 + __builtin_ctzll(bits);
+                return cursor + unsigned((slot - start) & (WAIT_WHEEL_SLOTS - 1));
+            }
+        }
+        return later.front().completion_time;
+    }
+};
+
+//------------------------------ ADMISSION QUEUE ------------------------------
+
+//Arrived processes waiting for memory, each at a position that orders them
+//by input: its handle, or with `by_arrival` (streamed input, whose handles
+//are reused) the next free position when it is inserted. A min tree over
+//their sizes finds the first one in input order that is small enough for
+//the memory left in O(log n), so a retry skips those that cannot fit
+struct blocked_queue{
+    static constexpr unsigned int EMPTY = UINT32_MAX;   // no blocked process below
+
+    std::size_t                 slots;          // handles that can be blocked
+    bool                        by_arrival;
+    std::size_t                 leaves = 1;
+    std::vector<unsigned int>   smallest;       // min size per subtree, built on first use
+    std::size_t                 count = 0;
+    std::vector<pcb_handle>     handles;        // by_arrival: handle at each position
+    std::size_t                 next_position = 0;
+
+    explicit blocked_queue(std::size_t slots, bool by_arrival = false)
+        : slots(slots), by_arrival(by_arrival) {}
+
+    //Blocks `handle`. With `by_arrival`, processes must be inserted in input order
+    void insert(pcb_handle handle, unsigned int size) {
+        size = std::min(size, EMPTY - 1);          // EMPTY - 1 is still tried
+        if (by_arrival) {
+            if (next_position == handles.size()) compact();
+            handles[next_position] = handle;
+            set(next_position++, size);
+        } else {
+            if (smallest.empty()) {
+                while (leaves < slots) leaves *= 2;
+                smallest.assign(2 * leaves, EMPTY);
+            }
+            set(handle, size);
+        }
+        count++;
+    }
+
+    //Unblocks the process at a position find returned
+    void erase(std::size_t position) {
+        set(position, EMPTY);
+        count--;
+    }
+
+    pcb_handle handle(std::size_t position) const {
+        return by_arrival ? handles[position] : pcb_handle(position);
+    }
+
+    bool empty() const { return count == 0; }
+
+    void save(snapshot_writer &out) const {
+        out.put(leaves);
+        out.put(smallest);
+        out.put(count);
+        out.put(handles);
+        out.put(next_position);
+    }
+    void restore(snapshot_reader &in) {
+        in.get(leaves);
+        in.get(smallest);
+        in.get(count);
+        in.get(handles);
+        in.get(next_position);
+        if (!smallest.empty() && smallest.size() != 2 * leaves) in.fail();
+        if (by_arrival && (handles.size() != (smallest.empty() ? 0 : leaves) ||
+                           next_position > handles.size())) {
+            in.fail();
+        }
+    }
+
+    //First blocked position >= from whose size is <= capacity, or NO_PROCESS
+    pcb_handle find(pcb_handle from, unsigned int capacity) const {
+        if (count == 0) return NO_PROCESS;
+        return find(1, 0, leaves, from, capacity);
+    }
+
+private:
+    void set(std::size_t position, unsigned int size) {
+        std::size_t node = leaves + position;
+        smallest[node] = size;
+        for (node /= 2; node > 0; node /= 2) {
+            smallest[node] = std::min(smallest[2 * node], smallest[2 * node + 1]);
+        }
+    }
+
+    //by_arrival: out of positions, move the blocked processes to the first
+    //ones, in order, in a tree with at least as many free positions again
+    void compact() {
+        std::vector<std::pair<pcb_handle, unsigned int>> kept;
+        for (std::size_t position = 0; position < next_position; position++) {
+            if (smallest[leaves + position] != EMPTY) {
+                kept.emplace_back(handles[position], smallest[leaves + position]);
+            }
+        }
+        leaves = 16;
+        while (leaves < 2 * kept.size()) leaves *= 2;
+        smallest.assign(2 * leaves, EMPTY);
+        handles.assign(leaves, NO_PROCESS);
+        next_position = 0;
+        for (const auto &process : kept) {
+            handles[next_position] = process.first;
+            set(next_position++, process.second);
+        }
+    }
+
+    //Search the subtree `node` covering handles [low, high)
+    pcb_handle find(std::size_t node, std::size_t low, std::size_t high,
+                    pcb_handle from, unsigned int capacity) const {
+        if (high <= from || smallest[node] > capacity) return NO_PROCESS;
+        if (high - low == 1) return pcb_handle(low);
 
-//Assign memory partition to program (simple best-fit by size, using template order)
-inline bool assign_memory(PCB &program) {
-    int size_to_fit = program.size;
-    int available_size = 0;
+        std::size_t middle = (low + high) / 2;
+        pcb_handle found = find(2 * node, low, middle, from, capacity);
+        if (found != NO_PROCESS) return found;
+        return find(2 * node + 1, middle, high, from, capacity);
+    }
+};
 
-    for(int i = 5; i >= 0; i--) {
-        available_size = memory_paritions[i].size;
+//Processes not admitted yet. Arrivals are read through a cursor over the
+//handles sorted by arrival time; arrived processes that did not fit in memory
+//wait in `blocked`, in input order, and are only retried once memory has
+//been released (an allocation alone can never make room for them).
+//With `streamed` input the table starts empty and read_arrivals appends
+//the arrivals as they are read, which is input order already
+struct admission_queue{
+    std::vector<pcb_handle> arrivals;          // by arrival time, then input order
+    std::size_t             next_arrival = 0;
+    blocked_queue           blocked;
+    std::vector<pcb_handle> arrived;           // scratch: arrivals of one admission
+    unsigned long           releases_seen = 0; // memory releases at the last retry
+    std::size_t             admitted = 0;      // processes admitted so far
+    bool                    streamed;
+    bool                    stream_open;       // streamed: more arrivals may be read
 
-        if(size_to_fit <= available_size && memory_paritions[i].occupied == -1) {
-            memory_paritions[i].occupied = program.PID;
-            program.partition_number = memory_paritions[i].partition_number;
-            return true;
+    explicit admission_queue(const pcb_table &processes, bool streamed = false)
+        : blocked(processes.size(), streamed), streamed(streamed), stream_open(streamed) {
+        for (pcb_handle handle = 0; handle < processes.size(); handle++) {
+            arrivals.push_back(handle);
         }
+        std::stable_sort(arrivals.begin(), arrivals.end(),
+                         [&](pcb_handle a, pcb_handle b) {
+                             return processes.info(a).arrival_time <
+                                    processes.info(b).arrival_time;
+                         });
+    }
+
+    //True once every process has arrived (admitted or blocked)
+    bool exhausted() const { return next_arrival == arrivals.size() && !stream_open; }
+
+    //`arrivals` only depends on the input, it is not saved. Streamed runs
+    //are not checkpointed
+    void save(snapshot_writer &out) const {
+        out.put(next_arrival);
+        blocked.save(out);
+        out.put(releases_seen);
+        out.put(admitted);
+    }
+    void restore(snapshot_reader &in) {
+        in.get(next_arrival);
+        blocked.restore(in);
+        in.get(releases_seen);
+        in.get(admitted);
+        if (next_arrival > arrivals.size()) in.fail();
     }
+};
+
+//--------------------------------- HELPERS -----------------------------------
+
+//Function that takes a queue as an input and outputs a string table of PCBs
+std::string print_PCB(const pcb_table &_PCB);
+
+//Overloaded function that takes a single process as input
+std::string print_PCB(const process_record &_PCB);
+
+//With `cpu_column`, the table of a multi-core run gains a CPU column on the right
+std::string print_exec_header(bool cpu_column = false);
+
+std::string print_exec_status(unsigned int current_time, int PID, states old_state, states new_state);
+
+//State names right-aligned in the 10-character state columns of the execution
+//table, as setw(10) prints them (NOT_ASSIGNED is wider and is not padded)
+struct padded_state_name{
+    char            text[13];
+    std::size_t     length;
+};
+
+constexpr padded_state_name padded_state_names[] = {
+    {"       NEW", 10},
+    {"     READY", 10},
+    {"   RUNNING", 10},
+    {"   WAITING", 10},
+    {"TERMINATED", 10},
+    {"NOT_ASSIGNED", 12}
+};
 
-    return false;
+//Longest row format_exec_status writes: 10-digit time, 11-character PID and CPU
+const std::size_t EXEC_STATUS_MAX = 80;
+
+//Writes `value` right-aligned in `width` characters, like setw(width)
+template <typename Integer>
+inline char *format_right(char *out, Integer value, int width) {
+    char digits[24];
+    char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    int padding = width - int(end - digits);
+    for (int i = 0; i < padding; i++) *out++ = ' ';
+    return std::copy(digits, end, out);
 }
 
-//Free a memory partition
-inline bool free_memory(PCB &program){
-    for(int i = 5; i >= 0; i--) {
-        if(program.PID == memory_paritions[i].occupied) {
-            memory_paritions[i].occupied = -1;
-            program.partition_number = -1;
-            return true;
+//Writes the row of print_exec_status into `out` (room for EXEC_STATUS_MAX
+//characters) without building a stream, and returns the end of the row.
+//A `cpu` >= 0 fills the CPU column of a multi-core table
+inline char *format_exec_status(char *out, unsigned int current_time, int PID,
+                                states old_state, states new_state, int cpu = -1) {
+    *out++ = '|';
+    out = format_right(out, current_time, 18);
+    *out++ = ' '; *out++ = '|';
+    out = format_right(out, PID, 3);
+    *out++ = ' '; *out++ = '|';
+    const padded_state_name &old_name = padded_state_names[old_state];
+    out = std::copy(old_name.text, old_name.text + old_name.length, out);
+    *out++ = ' '; *out++ = '|';
+    const padded_state_name &new_name = padded_state_names[new_state];
+    out = std::copy(new_name.text, new_name.text + new_name.length, out);
+    *out++ = ' '; *out++ = '|';
+    if (cpu >= 0) {
+        out = format_right(out, cpu, 4);
+        *out++ = ' '; *out++ = '|';
+    }
+    *out++ = '\n';
+    return out;
+}
+
+std::string print_exec_footer(bool cpu_column = false);
+
+//--------------------------------- OUTPUT ------------------------------------
+
+//Fixed-size write buffer in front of an output stream. Data is handed to the
+//stream one full chunk at a time, so the buffer never grows
+class output_buffer {
+public:
+    explicit output_buffer(std::ostream &out, std::size_t capacity = 64 * 1024)
+        : out(out), buffer(capacity), used(0) {}
+
+    ~output_buffer() { flush(); }
+
+    void write(const char *data, std::size_t length) {
+        if (length > buffer.size() - used) {
+            flush();
+            if (length > buffer.size()) {   // larger than a chunk, bypass the buffer
+                out.write(data, length);
+                return;
+            }
+        }
+        std::copy(data, data + length, buffer.begin() + used);
+        used += length;
+    }
+
+    void write(const std::string &text) { write(text.data(), text.size()); }
+
+    //Room for `length` bytes (at most the capacity) to be written in place,
+    //then handed back with commit(end of the written data)
+    char *reserve(std::size_t length) {
+        if (length > buffer.size() - used) flush();
+        return buffer.data() + used;
+    }
+
+    void commit(const char *end) { used = end - buffer.data(); }
+
+    void flush() {
+        if (used == 0) return;
+        out.write(buffer.data(), used);
+        used = 0;
+    }
+
+    //Checkpoints: everything written so far is handed to the stream and
+    //flushed, and its length returned; seek moves the stream back there
+    std::uint64_t tell() {
+        flush();
+        out.flush();
+        return static_cast<std::uint64_t>(out.tellp());
+    }
+
+    void seek(std::uint64_t position) {
+        flush();
+        out.seekp(static_cast<std::streamoff>(position));
+    }
+
+private:
+    std::ostream        &out;
+    std::vector<char>   buffer;
+    std::size_t         used;
+};
+
+//Where the CPU time of a core went: the bursts of its processes, and the
+//modeled overheads of the run (all 0 unless sim_options gives them a cost)
+struct cpu_time{
+    unsigned long long  useful = 0;            // CPU bursts of the processes
+    unsigned long long  context_switch = 0;    // saving one process, restoring another
+    unsigned long long  scheduler = 0;         // scheduler invocations, one per dispatch
+    unsigned long long  interrupt = 0;         // servicing I/O completion interrupts
+
+    unsigned long long overhead() const { return context_switch + scheduler + interrupt; }
+
+    cpu_time &operator+=(const cpu_time &other) {
+        useful += other.useful;
+        context_switch += other.context_switch;
+        scheduler += other.scheduler;
+        interrupt += other.interrupt;
+        return *this;
+    }
+};
+
+//Receives every state transition of a simulation as it happens, with the
+//core it happens on: the one the process runs on or leaves, or whose ready
+//queue it joins
+class exec_sink {
+public:
+    virtual ~exec_sink() {}
+    virtual void transition(unsigned int current_time, int PID,
+                            states old_state, states new_state,
+                            unsigned int cpu) = 0;
+    //Called once before finish with the CPU time of each core
+    virtual void cpu_times(const std::vector<cpu_time> &) {}
+    virtual void finish() = 0;     // called once after the last transition
+
+    //Checkpoints: save writes what the sink needs to carry on from here,
+    //restore reads it back into a sink built the same way
+    virtual void save(snapshot_writer &) {}
+    virtual void restore(snapshot_reader &) {}
+};
+
+//Streams the execution table (same format as print_exec_header/status/footer),
+//with a CPU column for multi-core runs
+class table_sink : public exec_sink {
+public:
+    explicit table_sink(std::ostream &out, bool cpu_column = false)
+        : buffer(out), cpu_column(cpu_column) {
+        buffer.write(print_exec_header(cpu_column));
+    }
+
+    void transition(unsigned int current_time, int PID,
+                    states old_state, states new_state,
+                    unsigned int cpu) override {
+        char *row = buffer.reserve(EXEC_STATUS_MAX);
+        buffer.commit(format_exec_status(row, current_time, PID, old_state, new_state,
+                                         cpu_column ? int(cpu) : -1));
+    }
+
+    void finish() override {
+        buffer.write(print_exec_footer(cpu_column));
+        buffer.flush();
+    }
+
+    //The table up to the checkpoint is in the file; a resumed run writes
+    //over whatever followed it
+    void save(snapshot_writer &out) override { out.put(buffer.tell()); }
+    void restore(snapshot_reader &in) override {
+        std::uint64_t position = 0;
+        in.get(position);
+        buffer.seek(position);
+    }
+
+private:
+    output_buffer buffer;
+    bool          cpu_column;
+};
+
+//Forwards transitions to `next`, timing it as the OUTPUT phase of the profile
+class profiled_sink : public exec_sink {
+public:
+    explicit profiled_sink(exec_sink *next) : next(next) {}
+
+    void transition(unsigned int current_time, int PID,
+                    states old_state, states new_state,
+                    unsigned int cpu) override {
+        phase_timer timer(OUTPUT_PHASE);
+        next->transition(current_time, PID, old_state, new_state, cpu);
+    }
+
+    void cpu_times(const std::vector<cpu_time> &times) override { next->cpu_times(times); }
+
+    void finish() override {
+        phase_timer timer(OUTPUT_PHASE);
+        next->finish();
+    }
+
+    void save(snapshot_writer &out) override { next->save(out); }
+    void restore(snapshot_reader &in) override { next->restore(in); }
+
+private:
+    exec_sink *next;
+};
+
+//Compact binary execution log (--format=bin), all integers little-endian:
+//  header, 8 bytes : magic "A3EX", uint16 version, uint16 record size
+//  record, 10 bytes: uint32 time, int32 PID, uint8 old state, uint8 new state
+//Multi-core runs write version 2, whose 11-byte records end with a uint8 CPU.
+//States are stored as their `states` enum value. metrics_101258593.py reads
+//both this format and the ASCII table
+const char          BINARY_LOG_MAGIC[4]   = {'A', '3', 'E', 'X'};
+const std::uint16_t BINARY_LOG_VERSION    = 1;
+const std::uint16_t BINARY_LOG_RECORD     = 10;
+const std::uint16_t BINARY_LOG_CPU_VERSION = 2;
+const std::uint16_t BINARY_LOG_CPU_RECORD = 11;
+const unsigned int  MAX_CPUS              = 256;    // CPUs a record can name
+
+class binary_sink : public exec_sink {
+public:
+    explicit binary_sink(std::ostream &out, bool cpu_column = false)
+        : buffer(out),
+          record_size(cpu_column ? BINARY_LOG_CPU_RECORD : BINARY_LOG_RECORD) {
+        char header[8];
+        std::copy(BINARY_LOG_MAGIC, BINARY_LOG_MAGIC + 4, header);
+        put_le(header + 4, cpu_column ? BINARY_LOG_CPU_VERSION : BINARY_LOG_VERSION, 2);
+        put_le(header + 6, record_size, 2);
+        buffer.write(header, sizeof(header));
+    }
+
+    void transition(unsigned int current_time, int PID,
+                    states old_state, states new_state,
+                    unsigned int cpu) override {
+        char record[BINARY_LOG_CPU_RECORD];
+        put_le(record, current_time, 4);
+        put_le(record + 4, static_cast<std::uint32_t>(PID), 4);
+        record[8] = static_cast<char>(old_state);
+        record[9] = static_cast<char>(new_state);
+        record[10] = static_cast<char>(cpu);
+        buffer.write(record, record_size);
+    }
+
+    void finish() override { buffer.flush(); }
+
+    void save(snapshot_writer &out) override { out.put(buffer.tell()); }
+    void restore(snapshot_reader &in) override {
+        std::uint64_t position = 0;
+        in.get(position);
+        buffer.seek(position);
+    }
+
+private:
+    static void put_le(char *out, std::uint32_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    output_buffer   buffer;
+    std::size_t     record_size;
+};
+
+//--------------------------------- METRICS -----------------------------------
+
+//Scheduling metrics, with the same definitions as metrics_101258593.py
+struct sim_metrics{
+    unsigned int    processes;         // processes that arrived (NEW -> READY)
+    unsigned int    finish_time;       // time of the last termination
+    double          throughput;        // processes per ms
+    double          avg_wait_time;     // time spent READY before each run
+    double          avg_turnaround;    // termination - arrival
+    double          avg_response;      // first run - arrival
+    std::vector<double> cpu_utilization;   // per core: time RUNNING / finish_time
+    cpu_time            cpu;               // all cores: useful work and overheads
+};
+
+//Computes sim_metrics from the transitions as they happen, then forwards
+//them to `next` (if any). Only live processes are tracked
+class metrics_sink : public exec_sink {
+public:
+    explicit metrics_sink(exec_sink *next = nullptr, unsigned int cpus = 1)
+        : next(next), busy(cpus, 0), run_start(cpus, 0) {}
+
+    //Tracks the PIDs first to last in a flat table sized here instead of
+    //the map, so the run allocates nothing per process. Any other PID
+    //still goes to the map. Called before the first transition
+    void index_pids(int first, int last) {
+        first_pid = first;
+        table.assign(std::size_t(static_cast<long long>(last) - first) + 1, process_times());
+    }
+
+    void transition(unsigned int current_time, int PID,
+                    states old_state, states new_state,
+                    unsigned int cpu) override {
+        if (cpu >= busy.size()) {
+            busy.resize(cpu + 1, 0);
+            run_start.resize(cpu + 1, 0);
         }
+        if (old_state == RUNNING) busy[cpu] += current_time - run_start[cpu];
+        if (new_state == RUNNING) run_start[cpu] = current_time;
+
+        if (old_state == NEW && new_state == READY) {
+            arrived++;
+            track(PID) = {current_time, current_time, false, true};
+        }
+
+        if (process_times *found = find(PID)) {
+            process_times &times = *found;
+
+            if (new_state == RUNNING) {
+                if (!times.has_run) {
+                    total_response += current_time - times.arrival;
+                    times.has_run = true;
+                }
+                total_wait += current_time - times.last_ready;
+            } else if (new_state == READY) {
+                times.last_ready = current_time;
+            } else if (new_state == TERMINATED) {
+                total_turnaround += current_time - times.arrival;
+                finish_time = std::max(finish_time, current_time);
+                forget(PID);
+            }
+        }
+
+        if (next) next->transition(current_time, PID, old_state, new_state, cpu);
+    }
+
+    void cpu_times(const std::vector<cpu_time> &times) override {
+        total_cpu = cpu_time();
+        for (const cpu_time &time : times) total_cpu += time;
+        if (next) next->cpu_times(times);
+    }
+
+    void finish() override {
+        if (next) next->finish();
+    }
+
+    void save(snapshot_writer &out) override {
+        std::uint64_t count = live.size();
+        for (const process_times &times : table) count += times.live;
+        out.put(count);
+        for (std::size_t index = 0; index < table.size(); index++) {
+            if (!table[index].live) continue;
+            out.put(int(first_pid + static_cast<long long>(index)));
+            out.put(table[index]);
+        }
+        for (const auto &process : live) {
+            out.put(process.first);
+            out.put(process.second);
+        }
+        out.put(arrived);
+        out.put(finish_time);
+        out.put(total_wait);
+        out.put(total_turnaround);
+        out.put(total_response);
+        out.put(busy);
+        out.put(run_start);
+        if (next) next->save(out);
+    }
+
+    void restore(snapshot_reader &in) override {
+        std::uint64_t count = 0;
+        in.get(count);
+        live.clear();
+        for (process_times &times : table) times.live = false;
+        for (std::uint64_t i = 0; i < count && in.ok(); i++) {
+            std::pair<int, process_times> process;
+            in.get(process.first);
+            in.get(process.second);
+            track(process.first) = process.second;
+        }
+        in.get(arrived);
+        in.get(finish_time);
+        in.get(total_wait);
+        in.get(total_turnaround);
+        in.get(total_response);
+        in.get(busy);
+        in.get(run_start);
+        if (next) next->restore(in);
+    }
+
+    sim_metrics result() const {
+        double n = arrived ? arrived : 1;
+        sim_metrics metrics;
+        metrics.processes      = arrived;
+        metrics.finish_time    = finish_time;
+        metrics.throughput     = finish_time ? arrived / double(finish_time) : 0.0;
+        metrics.avg_wait_time  = total_wait / n;
+        metrics.avg_turnaround = total_turnaround / n;
+        metrics.avg_response   = total_response / n;
+        for (unsigned long long time : busy) {
+            metrics.cpu_utilization.push_back(finish_time ? time / double(finish_time) : 0.0);
+        }
+        metrics.cpu            = total_cpu;
+        return metrics;
+    }
+
+private:
+    struct process_times{
+        unsigned int    arrival;
+        unsigned int    last_ready;
+        bool            has_run;
+        bool            live;           // in the table: the process is tracked
+    };
+
+    process_times *find(int PID) {
+        std::size_t index = std::size_t(static_cast<long long>(PID) - first_pid);
+        if (index < table.size()) return table[index].live ? &table[index] : nullptr;
+        auto it = live.find(PID);
+        return it == live.end() ? nullptr : &it->second;
+    }
+
+    process_times &track(int PID) {
+        std::size_t index = std::size_t(static_cast<long long>(PID) - first_pid);
+        return index < table.size() ? table[index] : live[PID];
+    }
+
+    void forget(int PID) {
+        std::size_t index = std::size_t(static_cast<long long>(PID) - first_pid);
+        if (index < table.size()) table[index].live = false;
+        else live.erase(PID);
     }
-    return false;
+
+    exec_sink                                   *next;
+    std::unordered_map<int, process_times>      live;
+    std::vector<process_times>                  table;          // PIDs from first_pid on
+    int                                         first_pid = 0;
+    unsigned int                                arrived = 0;
+    unsigned int                                finish_time = 0;
+    double                                      total_wait = 0;
+    double                                      total_turnaround = 0;
+    double                                      total_response = 0;
+    std::vector<unsigned long long>             busy;           // per core, time RUNNING
+    std::vector<unsigned int>                   run_start;      // per core, last dispatch
+    cpu_time                                    total_cpu;
+};
+
+//Prints the metrics in the same layout as metrics_101258593.py, plus the
+//utilization of each core for multi-core runs and the CPU time spent on
+//overheads when the run models any
+void print_metrics(std::ostream &out, const std::string &name,
+                   const sim_metrics &metrics);
+
+void print_metrics_json(std::ostream &out, const std::string &name,
+                        const sim_metrics &metrics,
+                        const std::string &policy = "");
+
+//`text` as a quoted JSON string: quotes, backslashes and control characters
+//are escaped, so any file name can go in the JSON outputs
+std::string json_string(const std::string &text);
+
+//--------------------------------- "OS" FUNCTIONS -----------------------------
+
+//Reserve memory for program with the simulation's memory manager
+inline bool assign_memory(memory_manager &memory, int PID, pcb_info &program) {
+    return memory.assign(program.size, PID,
+                         program.memory_slot, program.partition_number);
 }
 
-//Convert a list of strings into a PCB
-inline PCB add_process(std::vector<std::string> tokens) {
-    PCB process;
-    process.PID             = std::stoi(tokens[0]);
-    process.size            = std::stoi(tokens[1]);
-    process.arrival_time    = std::stoi(tokens[2]);
-    process.processing_time = std::stoi(tokens[3]);
-    process.remaining_time  = std::stoi(tokens[3]);
-    process.io_freq         = std::stoi(tokens[4]);
-    process.io_duration     = std::stoi(tokens[5]);
-    process.start_time      = -1;
-    process.partition_number= -1;
+//Free the memory held by program, straight from its slot
+inline bool free_memory(memory_manager &memory, pcb_info &program){
+    if(program.memory_slot == -1) return false;
+
+    memory.release(program.memory_slot, program.size);
+    program.memory_slot = -1;
+    program.partition_number = -1;
+    return true;
+}
+
+//Convert the fields of an input line into a process
+inline process_record add_process(int PID, unsigned int size, unsigned int arrival_time,
+                                  unsigned int processing_time, unsigned int io_freq,
+                                  unsigned int io_duration) {
+    process_record record;
+    pcb_info &info = record.info;
+    info.size             = size;
+    info.arrival_time     = arrival_time;
+    info.processing_time  = processing_time;
+    info.io_freq          = io_freq;
+    info.io_duration      = io_duration;
+    info.start_time       = -1;
+    info.partition_number = -1;
+    info.memory_slot      = -1;
+
+    PCB &process = record.pcb;
+    process.PID             = PID;
+    process.remaining_time  = processing_time;
+    process.io_freq         = io_duration > 0 ? io_freq : 0;
     process.state           = NOT_ASSIGNED;
 
     // extra fields
     process.cpu_since_last_io = 0;
     process.io_remaining      = 0;
     process.time_in_quantum   = 0;
-    // external priority: here we just use PID (smaller PID = higher priority)
+    // external priority: the PID unless the input line gives one
+    // (smaller = higher priority)
     process.priority          = process.PID;
+    process.cpu               = -1;
+    process.level             = 0;
+    process.level_boosts      = 0;
 
-    return process;
+    return record;
 }
 
-//Returns true if all processes in the queue have terminated
-inline bool all_process_terminated(std::vector<PCB> processes) {
+//------------------------------- INPUT PARSER --------------------------------
 
-    for(auto process : processes) {
-        if(process.state != TERMINATED) {
-            return false;
+//Tokenizes one input line in place: "PID, size, arrival, burst, io_freq,
+//io_duration[, priority]", with any amount of blanks around the commas.
+//Without a priority column the priority is the PID. Returns an error
+//message, or an empty string if the line is valid
+std::string parse_process_line(const char *begin, const char *end,
+                               process_record &process);
+
+//Reads the whole input file with a single read and parses it line by line
+//without copying. Blank lines are skipped. Returns false with a
+//"file:line: message" error for the first malformed line
+bool load_workload(const char *file_name, pcb_table &processes,
+                   std::string &error);
+
+//Reads a workload one process at a time (--stream), from a file or from the
+//standard input ("-"), so a run can start before the input is complete and
+//never holds more of it than the next process. The lines are those of
+//load_workload and must come in arrival-time order
+class workload_stream {
+public:
+    explicit workload_stream(const std::string &file_name);
+
+    bool is_open() const { return in != nullptr; }
+
+    //The next process, or null at the end of the input. A malformed or out
+    //of order line also ends it, with error() set
+    const process_record *peek();
+    void pop() { has_next = false; }
+
+    //"file:line: message" for the line that ended the input early, or empty
+    const std::string &error() const { return message; }
+
+private:
+    std::ifstream   file;
+    std::istream    *in = nullptr;
+    std::string     name;
+    std::string     line;
+    unsigned long   line_number = 0;
+    unsigned int    last_arrival = 0;
+    process_record  next;
+    bool            has_next = false;
+    std::string     message;
+};
+
+//Streamed input: reads the processes arriving by `current_time` into the
+//table, in slots of terminated processes first, and queues them for
+//admission. Returns true if any was read
+inline bool read_arrivals(workload_stream &stream, pcb_table &processes,
+                          std::vector<pcb_handle> &free_slots,
+                          admission_queue &admission, unsigned int current_time) {
+    if (admission.next_arrival == admission.arrivals.size()) {
+        admission.arrivals.clear();         // keep only the arrivals not taken yet
+        admission.next_arrival = 0;
+    }
+    bool read = false;
+    const process_record *process = stream.peek();
+    for (; process && process->info.arrival_time <= current_time; process = stream.peek()) {
+        pcb_handle handle;
+        if (free_slots.empty()) {
+            handle = static_cast<pcb_handle>(processes.size());
+            processes.push_back(*process);
+        } else {
+            handle = free_slots.back();
+            free_slots.pop_back();
+            processes.set(handle, *process);
         }
+        admission.arrivals.push_back(handle);
+        stream.pop();
+        read = true;
     }
+    admission.stream_open = process != nullptr;
+    return read;
+}
 
-    return true;
+//Admit processes whose arrival_time <= current_time and that fit in memory,
+//in input order. Blocked processes are retried only after a release.
+//`cpus.push(handle)` puts a READY process on a core and returns the core
+template <typename CPUs>
+inline void admit_processes(pcb_table &processes,
+                            memory_manager &memory,
+                            admission_queue &admission,
+                            CPUs &cpus,
+                            exec_sink &sink,
+                            unsigned int current_time) {
+    std::vector<pcb_handle> &arrived = admission.arrived;
+    arrived.clear();
+    while (admission.next_arrival < admission.arrivals.size() &&
+           processes.info(admission.arrivals[admission.next_arrival]).arrival_time
+               <= current_time) {
+        arrived.push_back(admission.arrivals[admission.next_arrival++]);
+    }
+    if (!admission.streamed) std::sort(arrived.begin(), arrived.end());
+
+    auto admit = [&](pcb_handle handle) {
+        PCB &process = processes[handle];
+        if (!assign_memory(memory, process.PID, processes.info(handle))) {
+            profile_count(ADMISSION_FAILURES);
+            return false;
+        }
+
+        process.state = READY;
+        process.cpu_since_last_io = 0;
+        process.io_remaining = 0;
+        process.time_in_quantum = 0;
+
+        unsigned int cpu = cpus.push(handle);
+        admission.admitted++;
+
+        sink.transition(current_time,
+                        process.PID,
+                        NEW,
+                        READY,
+                        cpu);
+        return true;
+    };
+
+    blocked_queue &blocked = admission.blocked;
+    if (memory.releases() != admission.releases_seen) {
+        // memory was freed: everyone waiting gets another try, in input order.
+        // A process larger than the largest free block cannot fit, skip it
+        admission.releases_seen = memory.releases();
+        for (pcb_handle handle : arrived) {
+            blocked.insert(handle, processes.info(handle).size);
+        }
+        pcb_handle position = blocked.find(0, memory.largest_free());
+        while (position != NO_PROCESS) {
+            if (admit(blocked.handle(position))) blocked.erase(position);
+            position = blocked.find(position + 1, memory.largest_free());
+        }
+    } else {
+        // nothing freed since the blocked ones failed, only new arrivals can fit
+        for (pcb_handle handle : arrived) {
+            if (!admit(handle)) blocked.insert(handle, processes.info(handle).size);
+        }
+    }
 }
 
-//Terminates a given process
-inline void terminate_process(PCB &running, std::vector<PCB> &job_queue) {
-    running.remaining_time = 0;
-    running.state = TERMINATED;
-    free_memory(running);
-    sync_queue(job_queue, running);
+//WAITING -> READY for every process whose I/O completes by current_time.
+//The core a process is queued on services its I/O interrupt
+template <typename CPUs>
+inline void manage_wait_queue(pcb_table &processes,
+                              io_wait_queue &wait_queue,
+                              CPUs &cpus,
+                              exec_sink &sink,
+                              unsigned int current_time) {
+    while (wait_queue.due(current_time)) {
+        pcb_handle handle = wait_queue.pop();
+        PCB &p = processes[handle];
+
+        states old_state = p.state;
+        p.state = READY;
+        p.io_remaining = 0;
+        p.time_in_quantum = 0;
+        p.cpu_since_last_io = 0;   // reset for next I/O cycle
+
+        unsigned int cpu = cpus.push(handle);
+        cpus.interrupt(cpu);
+        sink.transition(current_time,
+                        p.PID,
+                        old_state,
+                        p.state,
+                        cpu);
+    }
 }
 
-//set the process in the ready queue to running (unused in A3, but keep)
-inline void run_process(PCB &running, std::vector<PCB> &job_queue,
-                        std::vector<PCB> &ready_queue, unsigned int current_time) {
-    running = ready_queue.back();
-    ready_queue.pop_back();
-    running.start_time = current_time;
-    running.state = RUNNING;
-    sync_queue(job_queue, running);
+//True when the run is over, in O(1): every process has arrived and the
+//stream, if any, is closed, every admitted process has terminated, and
+//each one still blocked can never fit: all were retried after the last
+//release, against memory that is now entirely free. With `admitted_only`
+//(--stop=admitted) the run ends as the original simulators did, once every
+//admitted process has terminated, even with arrivals still to come
+inline bool simulation_done(const admission_queue &admission,
+                            std::size_t terminated,
+                            const memory_manager &memory,
+                            bool admitted_only = false) {
+    if (terminated != admission.admitted) return false;
+    if (admitted_only && admission.admitted > 0) return true;
+    return admission.exhausted() &&
+           (admission.blocked.empty() || memory.releases() == admission.releases_seen);
 }
 
-inline void idle_CPU(PCB &running) {
-    running.start_time       = 0;
-    running.processing_time  = 0;
-    running.remaining_time   = 0;
-    running.arrival_time     = 0;
-    running.io_duration      = 0;
-    running.io_freq          = 0;
-    running.partition_number = 0;
-    running.size             = 0;
-    running.state            = NOT_ASSIGNED;
-    running.PID              = -1;
-    running.cpu_since_last_io= 0;
-    running.io_remaining     = 0;
-    running.time_in_quantum  = 0;
-    running.priority         = 0;
+//Terminates a given process
+inline void terminate_process(memory_manager &memory, PCB &process, pcb_info &info) {
+    process.remaining_time = 0;
+    process.state = TERMINATED;
+    free_memory(memory, info);
 }
 
 #endif  // INTERRUPTS_101258593_HPP_
@@ -0,0 +1,398 @@
+#include <cstdio>
+
+#include "interrupts_101258593.hpp"
+
+// Out-of-line helpers of interrupts_101258593.hpp, compiled once for every binary
+
+//------------------------------------ STATES ---------------------------------
+
+std::ostream& operator<<(std::ostream& os, const enum states& s) { //Overloading the << operator to make printing of the enum easier
+    return (os << state_names[s]);
+}
+
+//--------------------------------- HELPERS -----------------------------------
+
+std::string print_PCB(const pcb_table &_PCB) {
+    const int tableWidth = 83;
+
+    std::stringstream buffer;
+    
+    // Print top border
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+    
+    // Print headers
+    buffer << "|"
+           << std::setfill(' ') << std::setw(4) << "PID"
+           << std::setw(2) << "|"
+           << std::setfill(' ') << std::setw(11) << "Partition"
+           << std::setw(2) << "|"
+           << std::setfill(' ') << std::setw(5) << "Size"
+           << std::setw(2) << "|"
+           << std::setfill(' ') << std::setw(13) << "Arrival Time"
+           << std::setw(2) << "|"
+           << std::setfill(' ') << std::setw(11) << "Start Time"
+           << std::setw(2) << "|"
+           << std::setfill(' ') << std::setw(14) << "Remaining Time"
+           << std::setw(2) << "|"
+           << std::setfill(' ') << std::setw(11) << "State"
+           << std::setw(2) << "|" << std::endl;
+    
+    // Print separator
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+    
+    // Print each PCB entry
+    for (pcb_handle handle = 0; handle < _PCB.size(); handle++) {
+        const PCB &program = _PCB[handle];
+        const pcb_info &info = _PCB.info(handle);
+        buffer << "|"
+               << std::setfill(' ') << std::setw(4) << program.PID
+               << std::setw(2) << "|"
+               << std::setw(11) << info.partition_number
+               << std::setw(2) << "|"
+               << std::setw(5) << info.size
+               << std::setw(2) << "|"
+               << std::setw(13) << info.arrival_time
+               << std::setw(2) << "|"
+               << std::setw(11) << info.start_time
+               << std::setw(2) << "|"
+               << std::setw(14) << program.remaining_time
+               << std::setw(2) << "|"
+               << std::setw(11) << program.state
+               << std::setw(2) << "|" << std::endl;
+    }
+    
+    // Print bottom border
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+
+    return buffer.str();
+}
+
+std::string print_PCB(const process_record &_PCB) {
+    pcb_table table;
+    table.push_back(_PCB);
+    return print_PCB(table);
+}
+
+std::string print_exec_header(bool cpu_column) {
+
+    const int tableWidth = cpu_column ? 55 : 49;
+
+    std::stringstream buffer;
+    
+    // Print top border
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+    
+    // Print headers
+    buffer  << "|"
+            << std::setfill(' ') << std::setw(18) << "Time of Transition"
+            << std::setw(2) << "|"
+            << std::setfill(' ') << std::setw(3) << "PID"
+            << std::setw(2) << "|"
+            << std::setfill(' ') << std::setw(10) << "Old State"
+            << std::setw(2) << "|"
+            << std::setfill(' ') << std::setw(10) << "New State"
+            << std::setw(2) << "|";
+    if (cpu_column) {
+        buffer << std::setw(4) << "CPU" << std::setw(2) << "|";
+    }
+    buffer << std::endl;
+    
+    // Print separator
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+
+    return buffer.str();
+
+}
+
+std::string print_exec_status(unsigned int current_time, int PID, states old_state, states new_state) {
+    char row[EXEC_STATUS_MAX];
+    return std::string(row, format_exec_status(row, current_time, PID, old_state, new_state));
+}
+
+std::string print_exec_footer(bool cpu_column) {
+    const int tableWidth = cpu_column ? 55 : 49;
+    std::stringstream buffer;
+
+    // Print bottom border
+    buffer << "+" << std::setfill('-') << std::setw(tableWidth) << "+" << std::endl;
+
+    return buffer.str();
+}
+
+//--------------------------------- METRICS -----------------------------------
+
+void print_metrics(std::ostream &out, const std::string &name,
+                   const sim_metrics &metrics) {
+    out << std::fixed
+        << "\n===== Metrics for " << name << " =====\n"
+        << "Throughput:        " << std::setprecision(4) << metrics.throughput << " processes/ms\n"
+        << "Avg Wait Time:     " << std::setprecision(2) << metrics.avg_wait_time << " ms\n"
+        << "Avg Turnaround:    " << metrics.avg_turnaround << " ms\n"
+        << "Avg Response Time: " << metrics.avg_response << " ms" << std::endl;
+    if (metrics.cpu_utilization.size() > 1) {
+        out << std::setprecision(1) << "CPU Utilization:  ";
+        for (std::size_t cpu = 0; cpu < metrics.cpu_utilization.size(); cpu++) {
+            out << " " << cpu << ":" << 100 * metrics.cpu_utilization[cpu] << "%";
+        }
+        out << std::endl;
+    }
+    const cpu_time &cpu = metrics.cpu;
+    if (cpu.overhead() > 0) {
+        out << std::setprecision(1)
+            << "CPU Time:          " << cpu.useful << " ms useful, " << cpu.overhead()
+                                     << " ms overhead ("
+                                     << 100.0 * cpu.overhead() / (cpu.useful + cpu.overhead())
+                                     << "%)\n"
+            << "Overhead:          " << cpu.context_switch << " ms context switches, "
+                                     << cpu.scheduler << " ms scheduler, "
+                                     << cpu.interrupt << " ms interrupts" << std::endl;
+    }
+    out.unsetf(std::ios::floatfield);
+}
+
+std::string json_string(const std::string &text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        switch (c) {
+        case '"':  quoted += "\\\""; break;
+        case '\\': quoted += "\\\\"; break;
+        case '\b': quoted += "\\b"; break;
+        case '\f': quoted += "\\f"; break;
+        case '\n': quoted += "\\n"; break;
+        case '\r': quoted += "\\r"; break;
+        case '\t': quoted += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escape[7];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned char>(c));
+                quoted += escape;
+            } else {
+                quoted += c;
+            }
+        }
+    }
+    return quoted + "\"";
+}
+
+void print_metrics_json(std::ostream &out, const std::string &name,
+                        const sim_metrics &metrics,
+                        const std::string &policy) {
+    out << std::setprecision(10)
+        << "{\"input\": " << json_string(name) << ", ";
+    if (!policy.empty()) out << "\"policy\": " << json_string(policy) << ", ";
+    out << "\"processes\": " << metrics.processes << ", "
+        << "\"finish_time\": " << metrics.finish_time << ", "
+        << "\"throughput\": " << metrics.throughput << ", "
+        << "\"avg_wait_time\": " << metrics.avg_wait_time << ", "
+        << "\"avg_turnaround\": " << metrics.avg_turnaround << ", "
+        << "\"avg_response\": " << metrics.avg_response;
+    if (metrics.cpu_utilization.size() > 1) {
+        out << ", \"cpu_utilization\": [";
+        for (std::size_t cpu = 0; cpu < metrics.cpu_utilization.size(); cpu++) {
+            out << (cpu ? ", " : "") << metrics.cpu_utilization[cpu];
+        }
+        out << "]";
+    }
+    const cpu_time &cpu = metrics.cpu;
+    if (cpu.overhead() > 0) {
+        out << ", \"useful_time\": " << cpu.useful
+            << ", \"overhead_time\": " << cpu.overhead()
+            << ", \"overhead\": {\"context_switch\": " << cpu.context_switch
+            << ", \"scheduler\": " << cpu.scheduler
+            << ", \"interrupt\": " << cpu.interrupt << "}";
+    }
+    out << "}" << std::endl;
+}
+
+//------------------------------- INPUT PARSER --------------------------------
+
+std::string parse_process_line(const char *begin, const char *end,
+                               process_record &process) {
+    static const char *field_names[] = {
+        "PID", "size", "arrival time", "burst time", "I/O frequency", "I/O duration",
+        "priority"
+    };
+    const int field_count = 7;          // the last one, the priority, is optional
+    long long fields[field_count];
+    int fields_read = 0;
+
+    const char *pos = begin;
+    for (int i = 0; i < field_count; i++) {
+        while (pos < end && (*pos == ' ' || *pos == '\t')) pos++;
+
+        auto [next, ec] = std::from_chars(pos, end, fields[i]);
+        // the burst time must be at least 1 ms: the engines only end a
+        // process after it has run
+        if (ec != std::errc() || fields[i] < 0 || fields[i] > UINT32_MAX ||
+            ((i == 0 || i == 6) && fields[i] > INT32_MAX) || (i == 3 && fields[i] == 0)) {
+            return std::string("invalid ") + field_names[i] + " '" +
+                   std::string(pos, std::find(pos, end, ',')) + "'";
+        }
+        pos = next;
+        fields_read++;
+
+        while (pos < end && (*pos == ' ' || *pos == '\t')) pos++;
+        if (i == field_count - 2 && pos == end) break;
+        if (i < field_count - 1) {
+            if (pos == end || *pos != ',') {
+                return "expected 6 or 7 comma-separated fields";
+            }
+            pos++;
+        }
+    }
+    if (pos != end) {
+        return "unexpected text after the last field";
+    }
+
+    process = add_process(static_cast<int>(fields[0]),
+                          static_cast<unsigned int>(fields[1]),
+                          static_cast<unsigned int>(fields[2]),
+                          static_cast<unsigned int>(fields[3]),
+                          static_cast<unsigned int>(fields[4]),
+                          static_cast<unsigned int>(fields[5]));
+    if (fields_read == field_count) {
+        process.pcb.priority = static_cast<int>(fields[6]);
+    }
+    return "";
+}
+
+//End of the line [begin, end) without a trailing '\r' and blanks
+static const char *trim_line(const char *begin, const char *end) {
+    while (end > begin && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) {
+        end--;
+    }
+    return end;
+}
+
+bool load_workload(const char *file_name, pcb_table &processes,
+                   std::string &error) {
+    std::ifstream input_file(file_name, std::ios::binary | std::ios::ate);
+    if (!input_file.is_open()) {
+        error = std::string("Unable to open file: ") + file_name;
+        return false;
+    }
+
+    std::vector<char> data(static_cast<std::size_t>(input_file.tellg()));
+    input_file.seekg(0);
+    input_file.read(data.data(), data.size());
+    input_file.close();
+
+    const char *pos = data.data();
+    const char *end = pos + data.size();
+    unsigned long line_number = 0;
+
+    while (pos < end) {
+        const char *line_end = std::find(pos, end, '\n');
+        line_number++;
+
+        const char *trimmed = trim_line(pos, line_end);
+
+        if (trimmed > pos) {
+            process_record process;
+            std::string message = parse_process_line(pos, trimmed, process);
+            if (!message.empty()) {
+                error = std::string(file_name) + ":" +
+                        std::to_string(line_number) + ": " + message;
+                return false;
+            }
+            processes.push_back(process);
+        }
+
+        pos = (line_end < end) ? line_end + 1 : end;
+    }
+
+    return true;
+}
+
+workload_stream::workload_stream(const std::string &file_name) {
+    if (file_name == "-") {
+        in = &std::cin;
+        name = "<stdin>";
+        return;
+    }
+    file.open(file_name, std::ios::binary);
+    if (file.is_open()) in = &file;
+    name = file_name;
+}
+
+const process_record *workload_stream::peek() {
+    while (!has_next && in && std::getline(*in, line)) {
+        line_number++;
+        const char *begin = line.data();
+        const char *trimmed = trim_line(begin, begin + line.size());
+        if (trimmed == begin) continue;
+
+        std::string error = parse_process_line(begin, trimmed, next);
+        if (error.empty() && next.info.arrival_time < last_arrival) {
+            error = "arrival time " + std::to_string(next.info.arrival_time) +
+                    " is before the previous one, a streamed input must be"
+                    " sorted by arrival time";
+        }
+        if (!error.empty()) {
+            message = name + ":" + std::to_string(line_number) + ": " + error;
+            in = nullptr;
+            break;
+        }
+        last_arrival = next.info.arrival_time;
+        has_next = true;
+    }
+    return has_next ? &next : nullptr;
+}
+
+//------------------------------- INSTRUMENTATION -----------------------------
+
+static const char *counter_names[PROFILE_COUNTERS] = {
+    "context_switches", "priority_preemptions", "quantum_preemptions",
+    "io_requests", "admission_failures", "engine_steps"
+};
+
+static const char *phase_names[PROFILE_PHASES] = {
+    "admission", "wait_queue", "cpu", "dispatch", "output", "run"
+};
+
+static double phase_ms(const sim_profile &profile, profile_phase phase) {
+    return profile.phase_ns[phase] / 1e6;
+}
+
+void print_profile(std::ostream &out, const std::string &name,
+                   const std::string &policy, const sim_profile &profile) {
+    const unsigned long long *count = profile.counters;
+    double timed = 0;
+    for (int phase = ADMISSION_PHASE; phase <= DISPATCH_PHASE; phase++) {
+        timed += phase_ms(profile, profile_phase(phase));
+    }
+
+    out << std::fixed << std::setprecision(3)
+        << "\n===== Profile for " << name << " (" << policy << ") =====\n"
+        << "Context switches:   " << count[CONTEXT_SWITCHES] << "\n"
+        << "Preemptions:        " << count[PRIORITY_PREEMPTIONS] << " by priority, "
+                                  << count[QUANTUM_PREEMPTIONS] << " by quantum\n"
+        << "I/O requests:       " << count[IO_REQUESTS] << "\n"
+        << "Admission failures: " << count[ADMISSION_FAILURES] << "\n"
+        << "Engine steps:       " << count[ENGINE_STEPS] << "\n"
+        << "Admission:          " << phase_ms(profile, ADMISSION_PHASE) << " ms\n"
+        << "Wait queue:         " << phase_ms(profile, WAIT_QUEUE_PHASE) << " ms\n"
+        << "CPU step:           " << phase_ms(profile, CPU_PHASE) << " ms\n"
+        << "Dispatch:           " << phase_ms(profile, DISPATCH_PHASE) << " ms\n"
+        << "Engine loop, other: " << phase_ms(profile, RUN_PHASE) - timed << " ms\n"
+        << "Total:              " << phase_ms(profile, RUN_PHASE) << " ms\n"
+        << "Output (in phases): " << phase_ms(profile, OUTPUT_PHASE) << " ms" << std::endl;
+    out.unsetf(std::ios::floatfield);
+}
+
+void print_profile_json(std::ostream &out, const std::string &name,
+                        const std::string &policy, const sim_profile &profile) {
+    out << "{\"input\": " << json_string(name) << ", \"policy\": " << json_string(policy) << ", "
+        << "\"counters\": {";
+    for (int counter = 0; counter < PROFILE_COUNTERS; counter++) {
+        out << (counter ? ", " : "") << "\"" << counter_names[counter] << "\": "
+            << profile.counters[counter];
+    }
+    out << "}, \"phase_ms\": {" << std::fixed << std::setprecision(6);
+    for (int phase = 0; phase < PROFILE_PHASES; phase++) {
+        out << (phase ? ", " : "") << "\"" << phase_names[phase] << "\": "
+            << phase_ms(profile, profile_phase(phase));
+    }
+    out << "}}" << std::endl;
+    out.unsetf(std::ios::floatfield);
+}
@@ -0,0 +1,592 @@
+/**
+ * @file memory_101258593.hpp
+ * @brief Memory managers: fixed partitions, variable partitions and buddy system
+ * @author 101258593
+ *
+ * A simulation reserves memory for a process when it is admitted and
+ * releases it when the process terminates. Every manager hands out a slot
+ * (its own handle for the memory, stored in the PCB) so release never has to
+ * search, and keeps an index of its free memory so finding room for a process
+ * is O(log n) in the number of partitions or holes. The one exception is
+ * variable first-fit, which walks the holes in address order: O(n) in the
+ * holes when a process fits, O(1) when none is large enough. Layouts and
+ * strategies can be loaded from a small "key = value" config file.
+ */
+
+#ifndef MEMORY_101258593_HPP_
+#define MEMORY_101258593_HPP_
+
+#include <ostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <memory>
+#include <fstream>
+#include <charconv>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+#include "snapshot_101258593.hpp"
+
+struct memory_partition{
+    unsigned int    partition_number;
+    unsigned int    size;
+    int             occupied;          // PID of process, or -1 if free
+};
+
+//Layout of the fixed partitions a simulation uses unless configured otherwise
+const memory_partition default_partitions[] = {
+    {1, 40, -1},
+    {2, 25, -1},
+    {3, 15, -1},
+    {4, 10, -1},
+    {5, 8, -1},
+    {6, 2, -1}
+};
+
+//How memory was used over a run. Fragmentation is sampled after every
+//assignment and release, the maxima are over the whole run
+struct memory_stats{
+    unsigned int    total = 0;                     // memory managed
+    unsigned int    allocations = 0;               // successful assignments
+    unsigned int    peak_used = 0;                 // most memory reserved at once
+    unsigned int    peak_requested = 0;            // most memory asked for at once
+    unsigned int    max_internal_fragmentation = 0;  // reserved - requested
+    double          max_external_fragmentation = 0;  // 1 - largest free / free
+};
+
+//Memory of one simulation. Subclasses implement a strategy; this class keeps
+//the statistics so every strategy reports them the same way
+class memory_manager {
+public:
+    explicit memory_manager(unsigned int total) { statistics.total = total; }
+    virtual ~memory_manager() = default;
+
+    //Reserves memory for a process of `size` owned by `PID`. On success
+    //`slot` is the handle to release it with and `partition_number` the
+    //number to report (the block address for variable and buddy)
+    bool assign(unsigned int size, int PID, int &slot, int &partition_number) {
+        unsigned int reserved = 0;
+        if (!allocate(size, PID, slot, partition_number, reserved)) return false;
+        used += reserved;
+        requested += size;
+        statistics.allocations++;
+        sample();
+        return true;
+    }
+
+    //Releases the memory of `slot`, reserved for a process of `size`
+    void release(int slot, unsigned int size) {
+        used -= deallocate(slot);
+        requested -= size;
+        release_count++;
+        sample();
+    }
+
+    const memory_stats &stats() const { return statistics; }
+
+    //Number of releases so far: memory can only have gained room if it changed
+    unsigned long releases() const { return release_count; }
+
+    //Largest free partition, hole or block: no bigger process can be assigned
+    virtual unsigned int largest_free() const = 0;
+
+    //Checkpoints: the statistics and the strategy's free and allocated memory
+    void save(snapshot_writer &out) const {
+        out.put(statistics);
+        out.put(used);
+        out.put(requested);
+        out.put(release_count);
+        save_state(out);
+    }
+
+    void restore(snapshot_reader &in) {
+        in.get(statistics);
+        in.get(used);
+        in.get(requested);
+        in.get(release_count);
+        restore_state(in);
+    }
+
+protected:
+    virtual bool allocate(unsigned int size, int PID, int &slot,
+                          int &partition_number, unsigned int &reserved) = 0;
+    virtual unsigned int deallocate(int slot) = 0;    // returns the memory freed
+    virtual void save_state(snapshot_writer &out) const = 0;
+    virtual void restore_state(snapshot_reader &in) = 0;
+
+private:
+    void sample() {
+        statistics.peak_used = std::max(statistics.peak_used, used);
+        statistics.peak_requested = std::max(statistics.peak_requested, requested);
+        statistics.max_internal_fragmentation =
+            std::max(statistics.max_internal_fragmentation, used - requested);
+
+        unsigned int free_memory = statistics.total - used;
+        if (free_memory > 0) {
+            double external = 1.0 - double(largest_free()) / free_memory;
+            statistics.max_external_fragmentation =
+                std::max(statistics.max_external_fragmentation, external);
+        }
+    }
+
+    memory_stats    statistics;
+    unsigned int    used = 0;
+    unsigned int    requested = 0;
+    unsigned long   release_count = 0;
+};
+
+//Fixed partitions. Best-fit takes the smallest free partition the process
+//fits in (the last one in the layout on ties, like the original scan from
+//the end); first-fit takes the first free partition in layout order
+class fixed_partitions : public memory_manager {
+public:
+    fixed_partitions(const std::vector<unsigned int> &sizes, bool best_fit)
+        : memory_manager(sum(sizes)), best_fit(best_fit), leaves(1) {
+        for (std::size_t i = 0; i < sizes.size(); i++) {
+            partitions.push_back({static_cast<unsigned int>(i + 1), sizes[i], -1});
+        }
+
+        if (best_fit) {
+            for (std::size_t i = 0; i < sizes.size(); i++) {
+                free_by_size.insert({sizes[i], -int(i)});
+            }
+        } else {
+            while (leaves < sizes.size()) leaves *= 2;
+            largest.assign(2 * leaves, 0);
+            for (std::size_t i = 0; i < sizes.size(); i++) {
+                set_free_size(i, std::uint64_t(sizes[i]) + 1);
+            }
+        }
+    }
+
+protected:
+    bool allocate(unsigned int size, int PID, int &slot,
+                  int &partition_number, unsigned int &reserved) override {
+        int index = best_fit ? find_best(size) : find_first(size);
+        if (index < 0) return false;
+
+        memory_partition &partition = partitions[index];
+        partition.occupied = PID;
+        if (best_fit) {
+            free_by_size.erase({partition.size, -index});
+        } else {
+            set_free_size(index, 0);
+        }
+
+        slot = index;
+        partition_number = partition.partition_number;
+        reserved = partition.size;
+        return true;
+    }
+
+    unsigned int deallocate(int slot) override {
+        memory_partition &partition = partitions[slot];
+        partition.occupied = -1;
+        if (best_fit) {
+            free_by_size.insert({partition.size, -slot});
+        } else {
+            set_free_size(slot, std::uint64_t(partition.size) + 1);
+        }
+        return partition.size;
+    }
+
+    void save_state(snapshot_writer &out) const override {
+        out.put(partitions);
+        out.put(free_by_size);
+        out.put(largest);
+    }
+
+    void restore_state(snapshot_reader &in) override {
+        in.get(partitions);
+        in.get(free_by_size);
+        in.get(largest);
+    }
+
+public:
+    unsigned int largest_free() const override {
+        if (best_fit) {
+            return free_by_size.empty() ? 0 : free_by_size.rbegin()->first;
+        }
+        return largest[1] ? unsigned(largest[1] - 1) : 0;
+    }
+
+private:
+    static unsigned int sum(const std::vector<unsigned int> &sizes) {
+        unsigned int total = 0;
+        for (unsigned int size : sizes) total += size;
+        return total;
+    }
+
+    //Smallest free partition >= size; -index orders ties from the last partition
+    int find_best(unsigned int size) const {
+        auto it = free_by_size.lower_bound({size, INT_MIN});
+        return it == free_by_size.end() ? -1 : -it->second;
+    }
+
+    //Leftmost free partition >= size, descending the max tree
+    int find_first(unsigned int size) const {
+        std::uint64_t needed = std::uint64_t(size) + 1;
+        if (largest[1] < needed) return -1;
+        std::size_t node = 1;
+        while (node < leaves) {
+            node = (largest[2 * node] >= needed) ? 2 * node : 2 * node + 1;
+        }
+        return int(node - leaves);
+    }
+
+    //Free size + 1 is stored, so 0 marks an occupied partition even for size 0
+    void set_free_size(std::size_t index, std::uint64_t size_plus_one) {
+        std::size_t node = leaves + index;
+        largest[node] = size_plus_one;
+        for (node /= 2; node > 0; node /= 2) {
+            largest[node] = std::max(largest[2 * node], largest[2 * node + 1]);
+        }
+    }
+
+    std::vector<memory_partition>       partitions;
+    bool                                best_fit;
+    std::set<std::pair<unsigned int, int>> free_by_size;   // best-fit: (size, -index)
+    std::size_t                         leaves;
+    std::vector<std::uint64_t>          largest;           // first-fit: max free size + 1 per subtree
+};
+
+//Variable partitioning of one contiguous memory: a process gets exactly its
+//size, carved from a hole, and freed blocks merge with adjacent holes
+class variable_partitions : public memory_manager {
+public:
+    variable_partitions(unsigned int total, bool best_fit)
+        : memory_manager(total), best_fit(best_fit) {
+        if (total > 0) add_hole(0, total);
+    }
+
+protected:
+    bool allocate(unsigned int size, int, int &slot,
+                  int &partition_number, unsigned int &reserved) override {
+        size = std::max(size, 1u);         // every process occupies an address
+
+        unsigned int start = 0, length = 0;
+        if (best_fit) {
+            auto it = holes_by_size.lower_bound({size, 0});
+            if (it == holes_by_size.end()) return false;
+            length = it->first;
+            start = it->second;
+        } else {
+            // first-fit has to walk the holes in address order, O(n) in the
+            // holes; the largest hole tells up front when the walk would fail
+            if (largest_free() < size) return false;
+            auto it = holes.begin();
+            while (it != holes.end() && it->second < size) ++it;
+            if (it == holes.end()) return false;
+            start = it->first;
+            length = it->second;
+        }
+
+        remove_hole(start, length);
+        if (length > size) add_hole(start + size, length - size);
+        blocks[start] = size;
+
+        slot = int(start);
+        partition_number = int(start);
+        reserved = size;
+        return true;
+    }
+
+    unsigned int deallocate(int slot) override {
+        auto block = blocks.find(unsigned(slot));
+        unsigned int start = block->first;
+        unsigned int length = block->second;
+        blocks.erase(block);
+        unsigned int freed = length;
+
+        auto next = holes.lower_bound(start);
+        if (next != holes.end() && next->first == start + length) {
+            length += next->second;
+            remove_hole(next->first, next->second);
+        }
+        auto prev = holes.lower_bound(start);
+        if (prev != holes.begin()) {
+            --prev;
+            if (prev->first + prev->second == start) {
+                start = prev->first;
+                length += prev->second;
+                remove_hole(prev->first, prev->second);
+            }
+        }
+        add_hole(start, length);
+        return freed;
+    }
+
+    void save_state(snapshot_writer &out) const override {
+        out.put(holes);
+        out.put(holes_by_size);
+        out.put(blocks);
+    }
+
+    void restore_state(snapshot_reader &in) override {
+        in.get(holes);
+        in.get(holes_by_size);
+        in.get(blocks);
+    }
+
+public:
+    unsigned int largest_free() const override {
+        return holes_by_size.empty() ? 0 : holes_by_size.rbegin()->first;
+    }
+
+private:
+    void add_hole(unsigned int start, unsigned int length) {
+        holes[start] = length;
+        holes_by_size.insert({length, start});
+    }
+
+    void remove_hole(unsigned int start, unsigned int length) {
+        holes.erase(start);
+        holes_by_size.erase({length, start});
+    }
+
+    bool                                        best_fit;
+    std::map<unsigned int, unsigned int>        holes;          // start -> length
+    std::set<std::pair<unsigned int, unsigned int>> holes_by_size;  // (length, start)
+    std::map<unsigned int, unsigned int>        blocks;         // start -> length
+};
+
+//Buddy system: blocks of min_block << k, split in halves on demand and
+//merged with their buddy on release. The managed memory is the largest
+//min_block << k that fits in the configured size
+class buddy_allocator : public memory_manager {
+public:
+    buddy_allocator(unsigned int total, unsigned int min_block)
+        : memory_manager(usable(total, min_block)), min_block(min_block) {
+        unsigned int block = min_block;
+        free_blocks.emplace_back();
+        while (block <= stats().total / 2) {
+            block *= 2;
+            free_blocks.emplace_back();
+        }
+        if (stats().total > 0) free_blocks.back().insert(0);
+    }
+
+protected:
+    bool allocate(unsigned int size, int, int &slot,
+                  int &partition_number, unsigned int &reserved) override {
+        std::size_t order = 0;
+        while (order < free_blocks.size() && block_size(order) < size) order++;
+
+        std::size_t from = order;
+        while (from < free_blocks.size() && free_blocks[from].empty()) from++;
+        if (from >= free_blocks.size()) return false;
+
+        unsigned int start = *free_blocks[from].begin();
+        free_blocks[from].erase(free_blocks[from].begin());
+        while (from > order) {             // keep the lower half, free the upper one
+            from--;
+            free_blocks[from].insert(start + block_size(from));
+        }
+        block_order[start] = order;
+
+        slot = int(start);
+        partition_number = int(start);
+        reserved = block_size(order);
+        return true;
+    }
+
+    unsigned int deallocate(int slot) override {
+        auto block = block_order.find(unsigned(slot));
+        unsigned int start = block->first;
+        std::size_t order = block->second;
+        block_order.erase(block);
+        unsigned int freed = block_size(order);
+
+        while (order + 1 < free_blocks.size()) {
+            unsigned int buddy = start ^ block_size(order);
+            auto it = free_blocks[order].find(buddy);
+            if (it == free_blocks[order].end()) break;
+            free_blocks[order].erase(it);
+            start = std::min(start, buddy);
+            order++;
+        }
+        free_blocks[order].insert(start);
+        return freed;
+    }
+
+    void save_state(snapshot_writer &out) const override {
+        for (const std::set<unsigned int> &blocks : free_blocks) out.put(blocks);
+        out.put(block_order);
+    }
+
+    void restore_state(snapshot_reader &in) override {
+        for (std::set<unsigned int> &blocks : free_blocks) in.get(blocks);
+        in.get(block_order);
+    }
+
+public:
+    unsigned int largest_free() const override {
+        for (std::size_t order = free_blocks.size(); order > 0; order--) {
+            if (!free_blocks[order - 1].empty()) return block_size(order - 1);
+        }
+        return 0;
+    }
+
+private:
+    static unsigned int usable(unsigned int total, unsigned int min_block) {
+        if (min_block == 0 || total < min_block) return 0;
+        unsigned int block = min_block;
+        while (block <= total / 2) block *= 2;
+        return block;
+    }
+
+    unsigned int block_size(std::size_t order) const { return min_block << order; }
+
+    unsigned int                            min_block;
+    std::vector<std::set<unsigned int>>     free_blocks;    // free block addresses per order
+    std::map<unsigned int, std::size_t>     block_order;    // allocated start -> order
+};
+
+//--------------------------------- CONFIG ------------------------------------
+
+//Which manager a simulation uses and its layout
+struct memory_config{
+    std::string                 allocator = "fixed-best-fit";
+    std::vector<unsigned int>   partitions;        // fixed-*: partition sizes in order
+    unsigned int                memory_size = 100; // variable-*, buddy: total memory
+    unsigned int                min_block = 1;     // buddy: smallest block
+
+    memory_config() {
+        for (const memory_partition &partition : default_partitions) {
+            partitions.push_back(partition.size);
+        }
+    }
+};
+
+inline bool is_allocator(const std::string &name) {
+    return name == "fixed-best-fit" || name == "fixed-first-fit" ||
+           name == "variable-best-fit" || name == "variable-first-fit" ||
+           name == "buddy";
+}
+
+//A fresh manager, with all memory free, for one simulation
+inline std::unique_ptr<memory_manager> make_memory_manager(const memory_config &config) {
+    if (config.allocator == "fixed-first-fit") {
+        return std::unique_ptr<memory_manager>(new fixed_partitions(config.partitions, false));
+    } else if (config.allocator == "variable-best-fit") {
+        return std::unique_ptr<memory_manager>(new variable_partitions(config.memory_size, true));
+    } else if (config.allocator == "variable-first-fit") {
+        return std::unique_ptr<memory_manager>(new variable_partitions(config.memory_size, false));
+    } else if (config.allocator == "buddy") {
+        return std::unique_ptr<memory_manager>(new buddy_allocator(config.memory_size, config.min_block));
+    }
+    return std::unique_ptr<memory_manager>(new fixed_partitions(config.partitions, true));
+}
+
+//Parses an unsigned number, the whole of [begin, end)
+inline bool parse_config_number(const char *begin, const char *end, unsigned int &value) {
+    auto [next, ec] = std::from_chars(begin, end, value);
+    return ec == std::errc() && next == end;
+}
+
+//Parses "40, 25, 8x1000": sizes, or SIZExCOUNT for COUNT partitions of SIZE
+inline bool parse_partition_list(const char *pos, const char *end,
+                                 std::vector<unsigned int> &partitions) {
+    partitions.clear();
+    while (pos < end) {
+        const char *item_end = std::find(pos, end, ',');
+        const char *first = pos, *last = item_end;
+        while (first < last && (*first == ' ' || *first == '\t')) first++;
+        while (last > first && (last[-1] == ' ' || last[-1] == '\t')) last--;
+
+        const char *times = std::find(first, last, 'x');
+        unsigned int size = 0, count = 1;
+        if (!parse_config_number(first, times, size) ||
+            (times != last && !parse_config_number(times + 1, last, count))) {
+            return false;
+        }
+        partitions.insert(partitions.end(), count, size);
+
+        pos = (item_end < end) ? item_end + 1 : end;
+    }
+    return !partitions.empty();
+}
+
+//Reads a memory config: "key = value" lines, '#' starts a comment. Keys are
+//allocator (fixed-best-fit, fixed-first-fit, variable-best-fit,
+//variable-first-fit, buddy), partitions, memory_size and min_block. Returns
+//false with a "file:line: message" error for the first bad line
+inline bool load_memory_config(const char *file_name, memory_config &config,
+                               std::string &error) {
+    std::ifstream config_file(file_name);
+    if (!config_file.is_open()) {
+        error = std::string("Unable to open file: ") + file_name;
+        return false;
+    }
+
+    std::string line;
+    unsigned long line_number = 0;
+    while (std::getline(config_file, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+
+        std::size_t equals = line.find('=');
+        std::size_t key_begin = line.find_first_not_of(" \t\r");
+        if (key_begin == std::string::npos) continue;
+
+        std::string message;
+        if (equals == std::string::npos) {
+            message = "expected key = value";
+        } else {
+            std::string key = line.substr(key_begin, equals - key_begin);
+            key = key.substr(0, key.find_last_not_of(" \t") + 1);
+            std::size_t value_begin = line.find_first_not_of(" \t", equals + 1);
+            std::size_t value_end = line.find_last_not_of(" \t\r") + 1;
+            std::string value = (value_begin == std::string::npos || value_begin >= value_end)
+                              ? "" : line.substr(value_begin, value_end - value_begin);
+            const char *begin = value.data(), *end = begin + value.size();
+
+            if (key == "allocator") {
+                if (!is_allocator(value)) message = "unknown allocator '" + value + "'";
+                else config.allocator = value;
+            } else if (key == "partitions") {
+                if (!parse_partition_list(begin, end, config.partitions))
+                    message = "invalid partitions '" + value + "'";
+            } else if (key == "memory_size") {
+                if (!parse_config_number(begin, end, config.memory_size))
+                    message = "invalid memory_size '" + value + "'";
+            } else if (key == "min_block") {
+                if (!parse_config_number(begin, end, config.min_block) || config.min_block == 0)
+                    message = "invalid min_block '" + value + "'";
+            } else {
+                message = "unknown key '" + key + "'";
+            }
+        }
+
+        if (!message.empty()) {
+            error = std::string(file_name) + ":" + std::to_string(line_number) +
+                    ": " + message;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//Prints the memory statistics of a run, in the layout of print_metrics
+inline void print_memory_stats(std::ostream &out, const std::string &name,
+                               const std::string &allocator,
+                               const memory_stats &stats) {
+    out << std::fixed
+        << "\n===== Memory for " << name << " =====\n"
+        << "Allocator:         " << allocator << "\n"
+        << "Total Memory:      " << stats.total << "\n"
+        << "Allocations:       " << stats.allocations << "\n"
+        << "Peak Used:         " << stats.peak_used << "\n"
+        << "Peak Requested:    " << stats.peak_requested << "\n"
+        << "Max Internal Frag: " << stats.max_internal_fragmentation << "\n"
+        << "Max External Frag: " << std::setprecision(2)
+        << stats.max_external_fragmentation * 100 << " %" << std::endl;
+    out.unsetf(std::ios::floatfield);
+}
+
+#endif  // MEMORY_101258593_HPP_
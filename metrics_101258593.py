@@ -7,11 +7,21 @@ your SYSC4001 Assignment 3 simulator (table with | and + borders).
 
 Usage:
     python3 metrics_101258593.py output_files/execution_EP_test2.txt
+    python3 metrics_101258593.py output_files/execution_EP.bin
 """
 
+import struct
 import sys
 
 
+# Binary log written with --format=bin (see binary_sink in interrupts_101258593.hpp)
+BINARY_MAGIC = b"A3EX"
+BINARY_HEADER = struct.Struct("<4sHH")      # magic, version, record size
+BINARY_RECORD = struct.Struct("<IiBB")      # time, PID, old state, new state
+BINARY_CPU_RECORD = struct.Struct("<IiBBB") # version 2 (multi-core): ..., CPU
+STATE_NAMES = ["NEW", "READY", "RUNNING", "WAITING", "TERMINATED", "NOT_ASSIGNED"]
+
+
 # --------------------------------------------------------------
 # Parse execution file
 # --------------------------------------------------------------
@@ -30,6 +40,7 @@ def parse_execution_file(file_path):
       - skip lines starting with '+'
       - parse lines starting with '|'
       - split by '|' and take columns: time, pid, old_state, new_state
+        and the CPU of multi-core runs (None without a CPU column)
     """
     transitions = []
     with open(file_path, "r") as f:
@@ -58,6 +69,7 @@ def parse_execution_file(file_path):
         pid      = cols[2]
         old_state = cols[3]
         new_state = cols[4]
+        cpu = int(cols[5]) if len(cols) > 6 and cols[5].isdigit() else None
 
         # Skip header row
         if time_str.startswith("Time"):
@@ -70,11 +82,43 @@ def parse_execution_file(file_path):
             # Not a numeric time -> skip
             continue
 
-        transitions.append((time, pid, old_state, new_state))
+        transitions.append((time, pid, old_state, new_state, cpu))
 
     return transitions
 
 
+def parse_binary_file(file_path):
+    """
+    Parse a binary execution log: an 8-byte header followed by fixed-size
+    (time, PID, old state, new state[, CPU]) records. Returns the same tuples
+    as parse_execution_file.
+    """
+    with open(file_path, "rb") as f:
+        data = f.read()
+
+    magic, version, record_size = BINARY_HEADER.unpack_from(data, 0)
+    if magic != BINARY_MAGIC:
+        raise RuntimeError("Not a binary execution log.")
+    if version == 1 and record_size == BINARY_RECORD.size:
+        records = (record + (None,) for record in
+                   BINARY_RECORD.iter_unpack(data[BINARY_HEADER.size:]))
+    elif version == 2 and record_size == BINARY_CPU_RECORD.size:
+        records = BINARY_CPU_RECORD.iter_unpack(data[BINARY_HEADER.size:])
+    else:
+        raise RuntimeError(f"Unsupported binary log version {version}.")
+
+    transitions = []
+    for time, pid, old, new, cpu in records:
+        transitions.append((time, str(pid), STATE_NAMES[old], STATE_NAMES[new], cpu))
+
+    return transitions
+
+
+def is_binary_file(file_path):
+    with open(file_path, "rb") as f:
+        return f.read(len(BINARY_MAGIC)) == BINARY_MAGIC
+
+
 # --------------------------------------------------------------
 # Compute metrics
 # --------------------------------------------------------------
@@ -85,6 +129,7 @@ def compute_metrics(transitions):
       - Average waiting time
       - Average turnaround time
       - Average response time
+      - Utilization of each CPU, for multi-core logs
 
     Definitions (per process):
       - arrival time: NEW -> READY transition time
@@ -93,14 +138,24 @@ def compute_metrics(transitions):
       - waiting time: sum of (time in READY state) before each RUNNING
       - turnaround:   finish_time - arrival_time
       - response:     first_run - arrival_time
+      - utilization:  time a CPU spends RUNNING a process / last finish_time
     """
     arrivals = {}
     first_run = {}
     finish_time = {}
     wait_time = {}
     last_ready_time = {}
+    busy = {}
+    run_start = {}
+
+    for (time, pid, old, new, cpu) in transitions:
 
-    for (time, pid, old, new) in transitions:
+        # time each CPU spends running
+        if cpu is not None:
+            if old == "RUNNING":
+                busy[cpu] = busy.get(cpu, 0) + time - run_start.get(cpu, 0)
+            if new == "RUNNING":
+                run_start[cpu] = time
 
         # NEW -> READY: arrival
         if new == "READY" and old == "NEW":
@@ -120,8 +175,8 @@ def compute_metrics(transitions):
         if new == "TERMINATED":
             finish_time[pid] = time
 
-        # WAITING -> READY: back into ready queue
-        if new == "READY" and old == "WAITING":
+        # WAITING/RUNNING -> READY: back into ready queue
+        if new == "READY" and old in ("WAITING", "RUNNING"):
             last_ready_time[pid] = time
 
     turnaround = {}
@@ -145,6 +200,11 @@ def compute_metrics(transitions):
         "avg_turnaround": sum(turnaround.values()) / n if n > 0 else 0.0,
         "avg_response": sum(response.values()) / n if n > 0 else 0.0,
     }
+    cpus = max(list(busy) + list(run_start), default=-1) + 1
+    if cpus > 1:
+        metrics["cpu_utilization"] = [busy.get(cpu, 0) / total_finish_time
+                                      if total_finish_time > 0 else 0.0
+                                      for cpu in range(cpus)]
     return metrics
 
 
@@ -157,6 +217,10 @@ def print_metrics(name, metrics):
     print(f"Avg Wait Time:     {metrics['avg_wait_time']:.2f} ms")
     print(f"Avg Turnaround:    {metrics['avg_turnaround']:.2f} ms")
     print(f"Avg Response Time: {metrics['avg_response']:.2f} ms")
+    if "cpu_utilization" in metrics:
+        cpus = " ".join(f"{cpu}:{100 * u:.1f}%"
+                        for cpu, u in enumerate(metrics["cpu_utilization"]))
+        print(f"CPU Utilization:   {cpus}")
 
 
 # --------------------------------------------------------------
@@ -168,7 +232,10 @@ def main():
         return
 
     file_path = sys.argv[1]
-    transitions = parse_execution_file(file_path)
+    if is_binary_file(file_path):
+        transitions = parse_binary_file(file_path)
+    else:
+        transitions = parse_execution_file(file_path)
     if not transitions:
         print("No valid transitions found in file – check format.")
         return
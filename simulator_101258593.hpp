@@ -0,0 +1,1356 @@
+/**
+ * @file simulator_101258593.hpp
+ * @brief Scheduling policies and the simulation engines shared by all simulators
+ * @author 101258593
+ *
+ * The engines are templates on a scheduling policy. A policy only decides
+ * which ready queue is used, whether a READY process preempts the running one,
+ * how long the time quantum is and how a process's level changes (MLFQ);
+ * everything else (admission, I/O, the event loop) is common. Each policy gets its own instantiation of the
+ * engine, so none of these decisions cost a runtime dispatch in the hot loop.
+ */
+
+#ifndef SIMULATOR_101258593_HPP_
+#define SIMULATOR_101258593_HPP_
+
+#include "interrupts_101258593.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+
+const unsigned int TIME_QUANTUM = 100;
+
+//Quantum of a policy instantiation that reads it from sim_options at run time
+const unsigned int VARIABLE_QUANTUM = UINT_MAX;
+
+//------------------------------- RUN OPTIONS ---------------------------------
+
+//How a workload is simulated, on top of the policy and memory layout
+struct sim_options{
+    bool                        tick_engine = false;
+    unsigned int                cpus = 1;
+    unsigned int                quantum = TIME_QUANTUM;     // RR, EP_RR
+    // MLFQ: quantum of each level, highest level first, and the period of the
+    // boost that moves every process back to level 0 (0 = never)
+    std::vector<unsigned int>   mlfq_quanta = {TIME_QUANTUM / 2, TIME_QUANTUM, 2 * TIME_QUANTUM};
+    unsigned int                mlfq_boost = 10 * TIME_QUANTUM;
+    // Overheads, in ms of the core they run on: a context switch when a core
+    // dispatches another process than the one it ran last, a scheduler
+    // invocation on every dispatch, and the service of each I/O completion
+    // interrupt. A dispatched process starts its burst once they are done
+    unsigned int                switch_cost = 0;
+    unsigned int                scheduler_cost = 0;
+    unsigned int                interrupt_cost = 0;
+    // End of the run (see simulation_done): once every process has run or
+    // can never fit, or, with stop_admitted, as the original simulators
+    // did, once every process admitted so far has terminated
+    bool                        stop_admitted = false;
+    // Checkpoints (see CHECKPOINTS): the run is saved to checkpoint_file
+    // (empty = never) every checkpoint_every s of wall time, the file names
+    // the run by checkpoint_key, and a run with a resume_snapshot (checked
+    // by read_checkpoint) starts from it instead of from time 0
+    std::string                 checkpoint_file;
+    unsigned int                checkpoint_every = 60;
+    std::uint64_t               checkpoint_key = 0;
+    std::string                 resume_snapshot;
+};
+
+const std::size_t MAX_MLFQ_LEVELS = 64;   // one bit each in mlfq_ready_queue::occupied
+
+//Parses a core count, 1 to MAX_CPUS
+inline bool parse_cpus(const std::string &value, unsigned int &cpus) {
+    const char *end = value.data() + value.size();
+    unsigned int parsed = 0;
+    auto [next, ec] = std::from_chars(value.data(), end, parsed);
+    if (ec != std::errc() || next != end || parsed < 1 || parsed > MAX_CPUS) return false;
+    cpus = parsed;
+    return true;
+}
+
+//Parses the MLFQ quanta "Q0,Q1,...": 1 to MAX_MLFQ_LEVELS quanta > 0
+inline bool parse_mlfq_quanta(const std::string &list, std::vector<unsigned int> &quanta) {
+    std::vector<unsigned int> parsed;
+    const char *pos = list.data();
+    const char *end = pos + list.size();
+    while (true) {
+        unsigned int quantum = 0;
+        auto [next, ec] = std::from_chars(pos, end, quantum);
+        if (ec != std::errc() || quantum == 0) return false;
+        parsed.push_back(quantum);
+        if (next == end) break;
+        if (*next != ',') return false;
+        pos = next + 1;
+    }
+    if (parsed.size() > MAX_MLFQ_LEVELS) return false;
+    quanta = parsed;
+    return true;
+}
+
+//Parses a non-negative number of ms
+inline bool parse_time(const std::string &value, unsigned int &time) {
+    const char *end = value.data() + value.size();
+    auto [next, ec] = std::from_chars(value.data(), end, time);
+    return ec == std::errc() && next == end && !value.empty();
+}
+
+//Sets the option `key` of a run from its text value. The same keys work on
+//the command line (--quantum=50, with dashes: --mlfq-quanta=...) and in a
+//--config file (quantum = 50, mlfq_quanta = ...). Returns an error message,
+//or an empty string if the value was set
+inline std::string set_sim_option(const std::string &key, const std::string &value,
+                                  sim_options &options) {
+    bool ok = true;
+    if (key == "engine") {
+        ok = value == "event" || value == "tick";
+        if (ok) options.tick_engine = (value == "tick");
+    } else if (key == "cpus") {
+        ok = parse_cpus(value, options.cpus);
+    } else if (key == "quantum") {
+        unsigned int quantum = 0;
+        ok = parse_time(value, quantum) && quantum > 0 && quantum != VARIABLE_QUANTUM;
+        if (ok) options.quantum = quantum;
+    } else if (key == "mlfq_quanta") {
+        ok = parse_mlfq_quanta(value, options.mlfq_quanta);
+    } else if (key == "mlfq_boost") {
+        ok = parse_time(value, options.mlfq_boost);
+    } else if (key == "switch_cost") {
+        ok = parse_time(value, options.switch_cost);
+    } else if (key == "scheduler_cost") {
+        ok = parse_time(value, options.scheduler_cost);
+    } else if (key == "interrupt_cost") {
+        ok = parse_time(value, options.interrupt_cost);
+    } else if (key == "stop") {
+        ok = value == "all" || value == "admitted";
+        if (ok) options.stop_admitted = (value == "admitted");
+    } else {
+        return "unknown key '" + key + "'";
+    }
+    return ok ? "" : "invalid " + key + " '" + value + "'";
+}
+
+//True if `option` is "--key=value" for a key of set_sim_option
+inline bool is_sim_option(const std::string &option) {
+    static const char *keys[] = {"engine", "cpus", "quantum", "mlfq-quanta", "mlfq-boost",
+                                 "switch-cost", "scheduler-cost", "interrupt-cost", "stop"};
+    for (const char *key : keys) {
+        std::string prefix = std::string("--") + key + "=";
+        if (option.rfind(prefix, 0) == 0) return true;
+    }
+    return false;
+}
+
+//Applies a "--key=value" option accepted by is_sim_option
+inline std::string set_sim_option(const std::string &option, sim_options &options) {
+    std::size_t equals = option.find('=');
+    std::string key = option.substr(2, equals - 2);
+    std::replace(key.begin(), key.end(), '-', '_');
+    return set_sim_option(key, option.substr(equals + 1), options);
+}
+
+//Reads run options from a file of "key = value" lines, as load_memory_config
+//does. Returns false with a "file:line: message" error for the first bad line
+inline bool load_sim_config(const char *file_name, sim_options &options,
+                            std::string &error) {
+    std::ifstream config_file(file_name);
+    if (!config_file.is_open()) {
+        error = std::string("Unable to open file: ") + file_name;
+        return false;
+    }
+
+    std::string line;
+    unsigned long line_number = 0;
+    while (std::getline(config_file, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+
+        std::size_t equals = line.find('=');
+        std::size_t key_begin = line.find_first_not_of(" \t\r");
+        if (key_begin == std::string::npos) continue;
+
+        std::string message;
+        if (equals == std::string::npos) {
+            message = "expected key = value";
+        } else {
+            std::string key = line.substr(key_begin, equals - key_begin);
+            key = key.substr(0, key.find_last_not_of(" \t") + 1);
+            std::size_t value_begin = line.find_first_not_of(" \t", equals + 1);
+            std::size_t value_end = line.find_last_not_of(" \t\r") + 1;
+            std::string value = (value_begin == std::string::npos || value_begin >= value_end)
+                              ? "" : line.substr(value_begin, value_end - value_begin);
+            message = set_sim_option(key, value, options);
+        }
+
+        if (!message.empty()) {
+            error = std::string(file_name) + ":" + std::to_string(line_number) +
+                    ": " + message;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//-------------------------------- MLFQ QUEUE ---------------------------------
+
+//Multi-level feedback queue: one FIFO per level, level 0 first. A bit mask
+//of the non-empty levels finds the front level with a single instruction, so
+//push and pop are O(1) whatever the number of READY processes
+struct mlfq_ready_queue{
+    pcb_table                       &processes;
+    std::vector<unsigned int>       quanta;
+    std::vector<fifo_ready_queue>   levels;
+    std::uint64_t                   occupied = 0;
+    std::size_t                     count = 0;
+
+    mlfq_ready_queue(pcb_table &processes, const sim_options &options)
+        : processes(processes), quanta(options.mlfq_quanta), levels(quanta.size()) {}
+
+    void push(pcb_handle handle) {
+        unsigned int level = processes[handle].level;
+        levels[level].push(handle);
+        occupied |= std::uint64_t(1) << level;
+        count++;
+    }
+
+    pcb_handle pop() {
+        unsigned int level = front_level();
+        pcb_handle handle = levels[level].pop();
+        if (levels[level].empty()) occupied &= ~(std::uint64_t(1) << level);
+        count--;
+        return handle;
+    }
+
+    unsigned int front_level() const { return __builtin_ctzll(occupied); }
+    pcb_handle front() const { return levels[front_level()].front(); }
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    void save(snapshot_writer &out) const {
+        for (const fifo_ready_queue &level : levels) level.save(out);
+        out.put(occupied);
+        out.put(count);
+    }
+    void restore(snapshot_reader &in) {
+        for (fifo_ready_queue &level : levels) level.restore(in);
+        in.get(occupied);
+        in.get(count);
+    }
+
+    //Priority boost: every queued process moves to level 0, level by level
+    //so they keep their order
+    void boost(unsigned int boosts) {
+        for (std::size_t level = 1; level < levels.size(); level++) {
+            while (!levels[level].empty()) {
+                pcb_handle handle = levels[level].pop();
+                processes[handle].level = 0;
+                processes[handle].level_boosts = boosts;
+                levels[0].push(handle);
+            }
+        }
+        occupied = count ? 1 : 0;
+    }
+};
+
+//------------------------------- POLICIES ------------------------------------
+
+//Besides its ready queue, a policy decides whether a READY process preempts
+//the running one (and so which core's running process a new READY one
+//should displace), how long the running process's quantum is (0 = no time
+//slicing), what happens to a process when it uses up its quantum or requests
+//I/O, and how often every process is boosted back to the top. These are the
+//defaults a policy overrides
+template <typename ReadyQueue>
+struct basic_policy{
+    typedef ReadyQueue ready_queue;
+
+    static ready_queue make_ready_queue(pcb_table &processes, const sim_options &) {
+        return ready_queue(processes);
+    }
+    static bool preempts(const ready_queue &, const PCB &) { return false; }
+    static bool outranks(const PCB &, const PCB &) { return false; }
+    static unsigned int quantum(const ready_queue &, const PCB &) { return 0; }
+    static void quantum_expired(const ready_queue &, PCB &) {}
+    static void io_requested(const ready_queue &, PCB &) {}
+    static unsigned int boost_period(const sim_options &) { return 0; }
+    static void boost(ready_queue &, unsigned int) {}
+};
+
+//External Priority: smaller priority value = higher priority, no preemption
+struct EP_policy : basic_policy<priority_ready_queue>{
+};
+
+//Time slicing of RR and EP_RR. A fixed Quantum is a compile-time constant of
+//the engine; VARIABLE_QUANTUM keeps the sim_options quantum next to the
+//ready queue instead
+template <unsigned int Quantum, typename Queue>
+struct time_slice{
+    typedef Queue ready_queue;
+
+    static ready_queue make_ready_queue(pcb_table &processes, const sim_options &) {
+        return ready_queue(processes);
+    }
+    static unsigned int quantum(const ready_queue &) { return Quantum; }
+};
+
+template <typename Queue>
+struct quantum_ready_queue : Queue{
+    unsigned int quantum;
+
+    quantum_ready_queue(const pcb_table &processes, unsigned int quantum)
+        : Queue(processes), quantum(quantum) {}
+};
+
+template <typename Queue>
+struct time_slice<VARIABLE_QUANTUM, Queue>{
+    typedef quantum_ready_queue<Queue> ready_queue;
+
+    static ready_queue make_ready_queue(pcb_table &processes, const sim_options &options) {
+        return ready_queue(processes, options.quantum);
+    }
+    static unsigned int quantum(const ready_queue &ready_queue) { return ready_queue.quantum; }
+};
+
+//Round Robin: FIFO ready queue, preemption by quantum
+template <unsigned int Quantum = TIME_QUANTUM>
+struct RR_policy : basic_policy<typename time_slice<Quantum, fifo_ready_queue>::ready_queue>{
+    typedef time_slice<Quantum, fifo_ready_queue> slice;
+    typedef typename slice::ready_queue ready_queue;
+
+    static ready_queue make_ready_queue(pcb_table &processes, const sim_options &options) {
+        return slice::make_ready_queue(processes, options);
+    }
+    static unsigned int quantum(const ready_queue &ready_queue, const PCB &) {
+        return slice::quantum(ready_queue);
+    }
+};
+
+//External Priority + Round Robin inside the same priority level
+template <unsigned int Quantum = TIME_QUANTUM>
+struct EP_RR_policy : basic_policy<typename time_slice<Quantum, priority_ready_queue>::ready_queue>{
+    typedef time_slice<Quantum, priority_ready_queue> slice;
+    typedef typename slice::ready_queue ready_queue;
+
+    static ready_queue make_ready_queue(pcb_table &processes, const sim_options &options) {
+        return slice::make_ready_queue(processes, options);
+    }
+    // The heap keeps the highest priority READY process at the front, so the
+    // preemption check only has to peek at it
+    static bool preempts(const ready_queue &ready_queue, const PCB &running) {
+        return !ready_queue.empty() &&
+               ready_queue.front_priority() < running.priority;
+    }
+    //True if `process` preempts `running` once it is at the front
+    static bool outranks(const PCB &process, const PCB &running) {
+        return process.priority < running.priority;
+    }
+    static unsigned int quantum(const ready_queue &ready_queue, const PCB &) {
+        return slice::quantum(ready_queue);
+    }
+};
+
+//Multi-level feedback queue: round robin inside each level with the level's
+//quantum. A process that uses up its quantum drops a level, one that
+//requests I/O before then climbs a level, and a periodic boost puts every
+//process back on level 0 so CPU-bound ones cannot starve. A READY process
+//on a higher level preempts the running one, as in EP_RR
+struct MLFQ_policy : basic_policy<mlfq_ready_queue>{
+    static ready_queue make_ready_queue(pcb_table &processes, const sim_options &options) {
+        return ready_queue(processes, options);
+    }
+    static bool preempts(const ready_queue &ready_queue, const PCB &running) {
+        return !ready_queue.empty() && ready_queue.front_level() < running.level;
+    }
+    static bool outranks(const PCB &process, const PCB &running) {
+        return process.level < running.level;
+    }
+    static unsigned int quantum(const ready_queue &ready_queue, const PCB &running) {
+        return ready_queue.quanta[running.level];
+    }
+    static void quantum_expired(const ready_queue &ready_queue, PCB &process) {
+        if (std::size_t(process.level) + 1 < ready_queue.levels.size()) process.level++;
+    }
+    static void io_requested(const ready_queue &, PCB &process) {
+        if (process.level > 0) process.level--;
+    }
+    static unsigned int boost_period(const sim_options &options) { return options.mlfq_boost; }
+    static void boost(ready_queue &ready_queue, unsigned int boosts) { ready_queue.boost(boosts); }
+};
+
+//--------------------------------- CPUS --------------------------------------
+
+//Where an idle core takes its next process from: `candidate` is another
+//core's queue, `chosen` the best one so far (its own queue to begin with).
+//FIFO queues (RR) only steal when the own queue is empty, from the longest
+//queue; priority queues (EP, EP_RR) and MLFQ take the highest priority
+//front of all cores, so priorities hold across cores and not only within one
+inline bool take_from(const fifo_ready_queue &candidate,
+                      const fifo_ready_queue &chosen, bool chosen_is_own) {
+    return chosen.empty() || (!chosen_is_own && candidate.size() > chosen.size());
+}
+
+inline bool take_from(const priority_ready_queue &candidate,
+                      const priority_ready_queue &chosen, bool) {
+    return chosen.empty() || lower_priority(chosen.heap.front(), candidate.heap.front());
+}
+
+inline bool take_from(const mlfq_ready_queue &candidate,
+                      const mlfq_ready_queue &chosen, bool) {
+    return chosen.empty() || candidate.front_level() < chosen.front_level();
+}
+
+//The simulated CPUs, each with the process it runs and its own ready queue.
+//With a single core this is exactly the uniprocessor of the original
+//simulators: one queue, nothing to balance or steal
+template <typename Policy>
+class cpu_set {
+public:
+    struct core{
+        pcb_handle                      running = NO_PROCESS;
+        unsigned int                    last_cpu_update = 0;   // time `running` was last brought up to date
+        typename Policy::ready_queue    ready_queue;
+        pcb_handle                      last_run = NO_PROCESS;  // last process dispatched here
+        unsigned int                    busy_until = 0;         // end of the overheads charged so far
+        unsigned int                    interrupts = 0;         // ms of interrupts not yet serviced
+        cpu_time                        time;
+
+        core(pcb_table &processes, const sim_options &options)
+            : ready_queue(Policy::make_ready_queue(processes, options)) {}
+
+        //CPU time `running` got since last_cpu_update: all of it but the overheads
+        unsigned int useful_time(unsigned int current_time) const {
+            return current_time - std::max(last_cpu_update, std::min(busy_until, current_time));
+        }
+
+        //Overheads still to run from current_time on, before `running` goes on
+        unsigned int overhead_left(unsigned int current_time) const {
+            return busy_until > current_time ? busy_until - current_time : 0;
+        }
+    };
+
+    cpu_set(pcb_table &processes, const sim_options &options)
+        : processes(processes), switch_cost(options.switch_cost),
+          scheduler_cost(options.scheduler_cost), interrupt_cost(options.interrupt_cost) {
+        cores.reserve(options.cpus);
+        for (unsigned int cpu = 0; cpu < options.cpus; cpu++) {
+            cores.emplace_back(processes, options);
+        }
+    }
+
+    unsigned int size() const { return static_cast<unsigned int>(cores.size()); }
+    core &operator[](unsigned int cpu) { return cores[cpu]; }
+
+    //Puts a READY process on the least loaded core (queued + running), the
+    //core it was last on if that is one of them, and returns that core. If
+    //every core is busy and the policy preempts, a process that outranks
+    //some running one goes to the core running the lowest of them instead,
+    //so it never preempts a core while another runs a lower process. A
+    //process that was WAITING through a priority boost gets it now
+    unsigned int push(pcb_handle handle) {
+        PCB &process = processes[handle];
+        if (process.level_boosts != boosts) {
+            process.level = 0;
+            process.level_boosts = boosts;
+        }
+        unsigned int cpu = 0;
+        if (cores.size() > 1) {
+            cpu = process.cpu >= 0 ? static_cast<unsigned int>(process.cpu) : 0;
+            for (unsigned int other = 0; other < cores.size(); other++) {
+                if (load(other) < load(cpu)) cpu = other;
+            }
+            if (cores[cpu].running != NO_PROCESS) cpu = lowest_outranked(process, cpu);
+        }
+        process.cpu = static_cast<std::int16_t>(cpu);
+        cores[cpu].ready_queue.push(handle);
+        return cpu;
+    }
+
+    //Next process for the idle core `cpu`, from its own queue or stolen from
+    //another core (see take_from), or NO_PROCESS if every queue is empty
+    pcb_handle take(unsigned int cpu) {
+        typename Policy::ready_queue *chosen = &cores[cpu].ready_queue;
+        for (unsigned int other = 0; other < cores.size(); other++) {
+            typename Policy::ready_queue &candidate = cores[other].ready_queue;
+            if (other != cpu && !candidate.empty() &&
+                take_from(candidate, *chosen, chosen == &cores[cpu].ready_queue)) {
+                chosen = &candidate;
+            }
+        }
+        return chosen->empty() ? NO_PROCESS : chosen->pop();
+    }
+
+    //Overheads of dispatching `handle` on core `cpu`: the scheduler, and a
+    //context switch unless the core's last process was `handle`
+    void dispatched(unsigned int cpu, pcb_handle handle, unsigned int current_time) {
+        core &core = cores[cpu];
+        unsigned int switch_time = core.last_run != handle ? switch_cost : 0;
+        core.last_run = handle;
+        core.time.context_switch += switch_time;
+        core.time.scheduler += scheduler_cost;
+        occupy(core, current_time, switch_time + scheduler_cost);
+    }
+
+    //An I/O completion interrupt for core `cpu`, serviced by run_interrupts
+    void interrupt(unsigned int cpu) {
+        cores[cpu].interrupts += interrupt_cost;
+    }
+
+    //Services the interrupts of core `cpu` from current_time on, once its
+    //running process is up to date, before it dispatches. Returns true if
+    //they delay a running process
+    bool run_interrupts(unsigned int cpu, unsigned int current_time) {
+        core &core = cores[cpu];
+        if (core.interrupts == 0) return false;
+        core.time.interrupt += core.interrupts;
+        occupy(core, current_time, core.interrupts);
+        core.interrupts = 0;
+        return core.running != NO_PROCESS;
+    }
+
+    //Streamed input: `handle` terminated and its slot will hold another
+    //process, which no core has run yet
+    void released(pcb_handle handle) {
+        for (core &core : cores) {
+            if (core.last_run == handle) core.last_run = NO_PROCESS;
+        }
+    }
+
+    std::vector<cpu_time> times() const {
+        std::vector<cpu_time> times;
+        for (const core &core : cores) times.push_back(core.time);
+        return times;
+    }
+
+    void save(snapshot_writer &out) const {
+        for (const core &core : cores) {
+            out.put(core.running);
+            out.put(core.last_cpu_update);
+            core.ready_queue.save(out);
+            out.put(core.last_run);
+            out.put(core.busy_until);
+            out.put(core.interrupts);
+            out.put(core.time);
+        }
+        out.put(boosts);
+    }
+
+    void restore(snapshot_reader &in) {
+        for (core &core : cores) {
+            in.get(core.running);
+            in.get(core.last_cpu_update);
+            core.ready_queue.restore(in);
+            in.get(core.last_run);
+            in.get(core.busy_until);
+            in.get(core.interrupts);
+            in.get(core.time);
+            if (core.running != NO_PROCESS && core.running >= processes.size()) in.fail();
+        }
+        in.get(boosts);
+    }
+
+    //Priority boost of the policy: queued and running processes move to the
+    //top now, WAITING ones when they are next pushed
+    void boost() {
+        boosts++;
+        for (core &core : cores) {
+            Policy::boost(core.ready_queue, boosts);
+            if (core.running != NO_PROCESS) {
+                processes[core.running].level = 0;
+                processes[core.running].level_boosts = boosts;
+            }
+        }
+    }
+
+private:
+    std::size_t load(unsigned int cpu) const {
+        return cores[cpu].ready_queue.size() + (cores[cpu].running != NO_PROCESS);
+    }
+
+    //The core running the lowest process that `process` outranks, the
+    //first of them on a tie, or `cpu` if it outranks none
+    unsigned int lowest_outranked(const PCB &process, unsigned int cpu) const {
+        const PCB *lowest = nullptr;
+        for (unsigned int other = 0; other < cores.size(); other++) {
+            if (cores[other].running == NO_PROCESS) continue;
+            const PCB &running = processes[cores[other].running];
+            if (Policy::outranks(process, running) &&
+                (!lowest || Policy::outranks(*lowest, running))) {
+                lowest = &running;
+                cpu = other;
+            }
+        }
+        return cpu;
+    }
+
+    //Overheads run back to back, from current_time or the end of the last one
+    static void occupy(core &core, unsigned int current_time, unsigned int ms) {
+        core.busy_until = std::max(core.busy_until, current_time) + ms;
+    }
+
+    pcb_table           &processes;
+    std::vector<core>   cores;
+    unsigned int        boosts = 0;
+    unsigned int        switch_cost;
+    unsigned int        scheduler_cost;
+    unsigned int        interrupt_cost;
+};
+
+//------------------------------ POLICY HOOKS ---------------------------------
+
+// Spend `elapsed` ms of CPU on the process running on core `cpu` (1 per
+// tick in the tick engine, the time since the last event in the event
+// engine) and apply the resulting transition. `ready_queue` is the core's
+// own queue. Returns the new state of the process.
+template <typename Policy>
+states execute_cpu(pcb_table &processes,
+                   memory_manager &memory,
+                   pcb_handle &running,
+                   typename Policy::ready_queue &ready_queue,
+                   io_wait_queue &wait_queue,
+                   exec_sink &sink,
+                   unsigned int current_time,
+                   unsigned int elapsed,
+                   unsigned int cpu)
+{
+    if (running == NO_PROCESS) return NOT_ASSIGNED;
+    PCB &process = processes[running];
+
+    // always spend the elapsed CPU time; a burst of 0 (the tick engine
+    // spends 1 ms before it checks) ends at 0 instead of wrapping around
+    process.remaining_time -= std::min(elapsed, process.remaining_time);
+    process.time_in_quantum += elapsed;
+
+    // Only track I/O if process actually uses I/O
+    bool has_io = process.io_freq > 0;
+    if (has_io) {
+        process.cpu_since_last_io += elapsed;
+
+        // I/O request?
+        if (process.cpu_since_last_io >= process.io_freq &&
+            process.remaining_time > 0)
+        {
+            states old_state = process.state;
+            process.state = WAITING;
+            process.io_remaining = processes.info(running).io_duration;
+            process.cpu_since_last_io = 0;
+            process.time_in_quantum = 0;
+            Policy::io_requested(ready_queue, process);
+            profile_count(IO_REQUESTS);
+
+            sink.transition(current_time, process.PID, old_state, process.state, cpu);
+
+            wait_queue.push(running, current_time + process.io_remaining);
+            running = NO_PROCESS;
+            return WAITING;
+        }
+    }
+
+    // Finished?
+    if (process.remaining_time == 0) {
+        states old_state = process.state;
+        terminate_process(memory, process, processes.info(running));
+
+        sink.transition(current_time, process.PID, old_state, process.state, cpu);
+
+        running = NO_PROCESS;
+        return TERMINATED;
+    }
+
+    // Preempt if the policy prefers a READY process (EP_RR: higher priority,
+    // MLFQ: higher level), or by quantum (RR inside same priority level)
+    bool by_priority = Policy::preempts(ready_queue, process);
+    unsigned int quantum = Policy::quantum(ready_queue, process);
+    if (by_priority || (quantum > 0 && process.time_in_quantum >= quantum)) {
+        profile_count(by_priority ? PRIORITY_PREEMPTIONS : QUANTUM_PREEMPTIONS);
+        if (!by_priority) Policy::quantum_expired(ready_queue, process);
+        states old_state = process.state;
+        process.state = READY;
+        process.time_in_quantum = 0;
+
+        sink.transition(current_time, process.PID, old_state, process.state, cpu);
+
+        // back of the ready queue
+        ready_queue.push(running);
+        running = NO_PROCESS;
+        return READY;
+    }
+
+    return RUNNING;
+}
+
+// Schedule the next transition the running process causes by itself
+// (I/O request, termination or end of quantum), with the same precedence
+// execute_cpu checks them in, once the core's pending `overhead` is done
+template <typename Policy>
+void schedule_cpu_event(event_queue &events,
+                        const pcb_table &processes,
+                        const typename Policy::ready_queue &ready_queue,
+                        pcb_handle running,
+                        unsigned int current_time,
+                        unsigned int overhead)
+{
+    const PCB &process = processes[running];
+    unsigned int delay = process.remaining_time;
+    event_type type = TERMINATION;
+
+    bool has_io = process.io_freq > 0;
+    if (has_io && process.io_freq - process.cpu_since_last_io < delay) {
+        delay = process.io_freq - process.cpu_since_last_io;
+        type = IO_REQUEST;
+    }
+    unsigned int quantum = Policy::quantum(ready_queue, process);
+    if (quantum > 0 && quantum - process.time_in_quantum < delay) {
+        delay = quantum - process.time_in_quantum;
+        type = QUANTUM_EXPIRY;
+    }
+
+    events.push(current_time + overhead + delay, type, running);
+}
+
+// If core `cpu` is idle, dispatch the front of a ready queue
+// (EP, EP_RR: highest priority, then lowest PID; RR: FIFO)
+template <typename Policy>
+void dispatch(pcb_table &processes,
+              cpu_set<Policy> &cpus,
+              unsigned int cpu,
+              exec_sink &sink,
+              unsigned int current_time)
+{
+    pcb_handle &running = cpus[cpu].running;
+    if (running != NO_PROCESS) return;
+
+    pcb_handle next = cpus.take(cpu);
+    if (next == NO_PROCESS) return;
+    PCB &process = processes[next];
+    process.cpu = static_cast<std::int16_t>(cpu);
+    cpus.dispatched(cpu, next, current_time);
+
+    states old_state = process.state;
+    process.state = RUNNING;
+    process.time_in_quantum = 0;
+    pcb_info &info = processes.info(next);
+    if (info.start_time == -1)
+        info.start_time = current_time;
+    profile_count(CONTEXT_SWITCHES);
+
+    sink.transition(current_time, process.PID, old_state, process.state, cpu);
+
+    running = next;
+}
+
+//------------------------------- CHECKPOINTS ---------------------------------
+
+//Everything an engine changes during a run, so that a checkpoint can save
+//it and a resumed run carry on exactly where the snapshot was taken
+template <typename Policy>
+struct sim_state{
+    pcb_table           processes;
+    cpu_set<Policy>     cpus;
+    io_wait_queue       wait_queue;
+    admission_queue     admission;
+    std::size_t         terminated = 0;
+    event_queue         events;             // event engine
+    unsigned int        current_time = 0;   // tick engine: the next tick to run
+    workload_stream     *stream;            // streamed input, or null
+    std::vector<pcb_handle> free_slots;     // streamed: slots of terminated processes
+
+    sim_state(pcb_table input, const sim_options &options, workload_stream *stream)
+        : processes(std::move(input)), cpus(processes, options),
+          admission(processes, stream != nullptr), stream(stream) {}
+
+    sim_state(const sim_state &) = delete;  // the queues refer to `processes`
+
+    //Streamed input: reads the processes arriving by `time`, see read_arrivals
+    bool read_arrivals(unsigned int time) {
+        return stream && ::read_arrivals(*stream, processes, free_slots, admission, time);
+    }
+
+    //Streamed input: the arrival time of the next process to read, if any
+    bool next_arrival(unsigned int &time) {
+        const process_record *process = stream ? stream->peek() : nullptr;
+        if (process) time = process->info.arrival_time;
+        return process != nullptr;
+    }
+
+    //A process terminated. A streamed run reuses its slot, so the table only
+    //grows with the number of processes in the system at once
+    void release(pcb_handle handle) {
+        if (!stream) return;
+        cpus.released(handle);
+        free_slots.push_back(handle);
+    }
+
+    void save(snapshot_writer &out) const {
+        processes.save(out);
+        cpus.save(out);
+        wait_queue.save(out);
+        admission.save(out);
+        out.put(terminated);
+        events.save(out);
+        out.put(current_time);
+    }
+
+    void restore(snapshot_reader &in) {
+        processes.restore(in);
+        cpus.restore(in);
+        wait_queue.restore(in);
+        admission.restore(in);
+        in.get(terminated);
+        events.restore(in);
+        in.get(current_time);
+    }
+};
+
+//Names a run for its checkpoints: a hash of the input, the policy, every
+//option that changes the run, the memory layout and `outputs`, which
+//describes the sinks the caller builds (their state is in the snapshot too)
+inline std::uint64_t checkpoint_key(const std::string &policy, const std::string &outputs,
+                                    const pcb_table &processes, const sim_options &options,
+                                    const memory_config &memory) {
+    std::uint64_t hash = fnv1a(policy.data(), policy.size());
+    hash = fnv1a(outputs.data(), outputs.size(), hash);
+    hash = fnv1a(processes.pcbs.data(), processes.size() * sizeof(PCB), hash);
+    hash = fnv1a(processes.infos.data(), processes.size() * sizeof(pcb_info), hash);
+    const unsigned int values[] = {
+        options.tick_engine, options.cpus, options.quantum, options.mlfq_boost,
+        options.switch_cost, options.scheduler_cost, options.interrupt_cost,
+        options.stop_admitted, memory.memory_size, memory.min_block
+    };
+    hash = fnv1a(values, sizeof(values), hash);
+    hash = fnv1a(options.mlfq_quanta.data(), options.mlfq_quanta.size() * sizeof(unsigned int), hash);
+    hash = fnv1a(memory.allocator.data(), memory.allocator.size(), hash);
+    return fnv1a(memory.partitions.data(), memory.partitions.size() * sizeof(unsigned int), hash);
+}
+
+//Why a run with a resume snapshot that passed read_checkpoint fails to start
+const char CHECKPOINT_MISMATCH[] = "checkpoint does not match this build";
+
+//Saves a run to options.checkpoint_file every checkpoint_every s of wall
+//time, with its memory and sinks, and restores it from resume_snapshot
+
+class checkpointer {
+public:
+    checkpointer(const sim_options &options, memory_manager &memory, exec_sink &sink)
+        : options(options), memory(memory), sink(sink),
+          next(std::chrono::steady_clock::now() + std::chrono::seconds(options.checkpoint_every)) {}
+
+    //Starts the run from options.resume_snapshot, if any. Returns false if
+    //the snapshot does not fit: its checksum and run key passed, so only a
+    //checkpoint of another build gets here
+    template <typename State>
+    bool restore(State &state) {
+        if (options.resume_snapshot.empty()) return true;
+        snapshot_reader in(options.resume_snapshot);
+        state.restore(in);
+        memory.restore(in);
+        sink.restore(in);
+        return in.ok() && in.at_end();
+    }
+
+    //Called at the start of every engine step, while the state is complete.
+    //The clock is only read every 1024 steps
+    template <typename State>
+    void step(const State &state) {
+        if (options.checkpoint_file.empty() || ++steps % 1024 != 0) return;
+        auto now = std::chrono::steady_clock::now();
+        if (now < next) return;
+        next = now + std::chrono::seconds(options.checkpoint_every);
+
+        std::ostringstream payload;
+        snapshot_writer out(payload);
+        state.save(out);
+        memory.save(out);
+        sink.save(out);
+        if (!write_checkpoint(options.checkpoint_file, options.checkpoint_key, payload.str()) &&
+            !warned) {
+            std::cerr << "Warning: unable to write checkpoint " << options.checkpoint_file
+                      << std::endl;
+            warned = true;
+        }
+    }
+
+private:
+    const sim_options                       &options;
+    memory_manager                          &memory;
+    exec_sink                               &sink;
+    std::chrono::steady_clock::time_point   next;
+    unsigned long                           steps = 0;
+    bool                                    warned = false;
+};
+
+//-------------------------------- ENGINES ------------------------------------
+
+// Discrete-event simulation: jumps from one event time to the next, running
+// the phases of a tick (admission, I/O completion, CPU step, dispatch) at each.
+// Every core is stepped at every event time, in core order. Returns false,
+// before any step, if the resume snapshot does not match this build
+template <typename Policy>
+bool run_simulation(pcb_table input, memory_manager &memory, exec_sink &sink,
+                    const sim_options &options, workload_stream *stream = nullptr) {
+
+    sim_state<Policy> state(std::move(input), options, stream);
+    pcb_table &processes = state.processes;
+    cpu_set<Policy> &cpus = state.cpus;
+    const unsigned int boost_period = Policy::boost_period(options);
+    io_wait_queue &wait_queue = state.wait_queue;
+    admission_queue &admission = state.admission;
+    std::size_t &terminated = state.terminated;
+    event_queue &events = state.events;
+    checkpointer checkpoints(options, memory, sink);
+
+    for (pcb_handle handle = 0; handle < processes.size(); handle++) {
+        events.push(processes.info(handle).arrival_time, ARRIVAL, handle);
+    }
+    unsigned int arrival_time;
+    if (state.next_arrival(arrival_time)) {
+        events.push(arrival_time, ARRIVAL, NO_PROCESS);
+    }
+    if (boost_period > 0) {
+        events.push(boost_period, PRIORITY_BOOST, NO_PROCESS);
+    }
+    if (!checkpoints.restore(state)) return false;
+
+    while (!events.empty()) {
+        checkpoints.step(state);
+
+        unsigned int current_time = events.top().time;
+        profile_count(ENGINE_STEPS);
+
+        // Boost the policy's priorities, then admit processes whose
+        // arrival_time <= current_time
+        bool admit = false, boost = false;
+        while (events.due(current_time, ARRIVAL)) {
+            (events.top().type == PRIORITY_BOOST ? boost : admit) = true;
+            events.pop();
+        }
+        if (boost) {
+            cpus.boost();
+            events.push(current_time + boost_period, PRIORITY_BOOST, NO_PROCESS);
+        }
+        if (admit) {
+            phase_timer timer(ADMISSION_PHASE);
+            // a streamed input has one arrival event, for its next process
+            if (state.read_arrivals(current_time) && state.next_arrival(arrival_time)) {
+                events.push(arrival_time, ARRIVAL, NO_PROCESS);
+            }
+            admit_processes(processes, memory, admission, cpus,
+                            sink, current_time);
+        }
+
+        // WAITING -> READY, the wait queue knows whose I/O completes now
+        while (events.due(current_time, IO_COMPLETION)) {
+            events.pop();
+        }
+        {
+            phase_timer timer(WAIT_QUEUE_PHASE);
+            manage_wait_queue(processes, wait_queue, cpus,
+                              sink, current_time);
+        }
+
+        // CPU events only wake the engine up, the CPU step re-checks them
+        while (!events.empty() && events.top().time == current_time) {
+            events.pop();
+        }
+
+        // CPU step (handles I/O, completion, preemption)
+        {
+            phase_timer timer(CPU_PHASE);
+            for (unsigned int cpu = 0; cpu < cpus.size(); cpu++) {
+                auto &core = cpus[cpu];
+                if (core.running == NO_PROCESS) continue;
+
+                pcb_handle current = core.running;
+                unsigned int elapsed = core.useful_time(current_time);
+                core.time.useful += elapsed;
+                states outcome = execute_cpu<Policy>(processes, memory, core.running,
+                                                     core.ready_queue, wait_queue, sink,
+                                                     current_time, elapsed, cpu);
+                core.last_cpu_update = current_time;
+
+                if (outcome == WAITING) {
+                    events.push(current_time + processes[current].io_remaining,
+                                IO_COMPLETION, current);
+                } else if (outcome == TERMINATED) {
+                    terminated++;
+                    state.release(current);
+                    // freed memory may admit a blocked process on the next ms
+                    events.push(current_time + 1, ARRIVAL, NO_PROCESS);
+                }
+            }
+        }
+
+        // Idle cores pick their next process. A boost may have shortened
+        // the quantum of the running ones and an interrupt delayed them,
+        // their next event is rescheduled
+        {
+            phase_timer timer(DISPATCH_PHASE);
+            for (unsigned int cpu = 0; cpu < cpus.size(); cpu++) {
+                auto &core = cpus[cpu];
+                bool stalled = cpus.run_interrupts(cpu, current_time);
+                if (core.running != NO_PROCESS) {
+                    if (boost || stalled) {
+                        schedule_cpu_event<Policy>(events, processes, core.ready_queue,
+                                                   core.running, current_time,
+                                                   core.overhead_left(current_time));
+                    }
+                    continue;
+                }
+
+                dispatch<Policy>(processes, cpus, cpu, sink, current_time);
+                if (core.running != NO_PROCESS) {
+                    core.last_cpu_update = current_time;
+                    schedule_cpu_event<Policy>(events, processes, core.ready_queue,
+                                               core.running, current_time,
+                                               core.overhead_left(current_time));
+                }
+            }
+        }
+
+        if (simulation_done(admission, terminated, memory, options.stop_admitted)) break;
+    }
+
+    sink.cpu_times(cpus.times());
+    sink.finish();
+    return true;
+}
+
+// Reference simulation, advancing 1 ms per iteration. Returns false as
+// run_simulation does
+template <typename Policy>
+bool run_simulation_ticks(pcb_table input, memory_manager &memory, exec_sink &sink,
+                          const sim_options &options, workload_stream *stream = nullptr) {
+
+    sim_state<Policy> state(std::move(input), options, stream);
+    pcb_table &processes = state.processes;
+    cpu_set<Policy> &cpus = state.cpus;
+    const unsigned int boost_period = Policy::boost_period(options);
+    io_wait_queue &wait_queue = state.wait_queue;
+    admission_queue &admission = state.admission;
+    std::size_t &terminated = state.terminated;
+    unsigned int &current_time = state.current_time;
+    checkpointer checkpoints(options, memory, sink);
+    if (!checkpoints.restore(state)) return false;
+
+    while (!simulation_done(admission, terminated, memory, options.stop_admitted)) {
+        checkpoints.step(state);
+        profile_count(ENGINE_STEPS);
+
+        // Boost the policy's priorities every boost_period ms
+        if (boost_period > 0 && current_time > 0 && current_time % boost_period == 0) {
+            cpus.boost();
+        }
+
+        // Admit processes whose arrival_time <= current_time
+        {
+            phase_timer timer(ADMISSION_PHASE);
+            state.read_arrivals(current_time);
+            admit_processes(processes, memory, admission, cpus,
+                            sink, current_time);
+        }
+
+        // WAITING -> READY
+        {
+            phase_timer timer(WAIT_QUEUE_PHASE);
+            manage_wait_queue(processes, wait_queue, cpus,
+                              sink, current_time);
+        }
+
+        // CPU step (handles I/O, completion, preemption)
+        {
+            phase_timer timer(CPU_PHASE);
+            for (unsigned int cpu = 0; cpu < cpus.size(); cpu++) {
+                auto &core = cpus[cpu];
+                // 1 ms, or none while the core runs overheads
+                pcb_handle current = core.running;
+                unsigned int elapsed = core.useful_time(current_time);
+                if (current != NO_PROCESS) core.time.useful += elapsed;
+                core.last_cpu_update = current_time;
+                if (execute_cpu<Policy>(processes, memory, core.running, core.ready_queue,
+                                        wait_queue, sink, current_time, elapsed,
+                                        cpu) == TERMINATED) {
+                    terminated++;
+                    state.release(current);
+                }
+            }
+        }
+
+        // Idle cores pick their next process
+        {
+            phase_timer timer(DISPATCH_PHASE);
+            for (unsigned int cpu = 0; cpu < cpus.size(); cpu++) {
+                cpus.run_interrupts(cpu, current_time);
+                dispatch<Policy>(processes, cpus, cpu, sink, current_time);
+            }
+        }
+
+        current_time++;
+    }
+
+    sink.cpu_times(cpus.times());
+    sink.finish();
+    return true;
+}
+
+//------------------------------ POLICY SELECTION -----------------------------
+
+//Runs one engine, starting a new profile of the calling thread
+template <typename Policy>
+bool run_policy(const pcb_table &processes, memory_manager &memory,
+                exec_sink &sink, const sim_options &options, workload_stream *stream) {
+    reset_profile();
+    phase_timer timer(RUN_PHASE);
+    if (options.tick_engine) {
+        return run_simulation_ticks<Policy>(processes, memory, sink, options, stream);
+    }
+    return run_simulation<Policy>(processes, memory, sink, options, stream);
+}
+
+inline bool is_policy(const std::string &policy) {
+    return policy == "EP" || policy == "RR" || policy == "EP_RR" || policy == "MLFQ";
+}
+
+//Runs the workload under the named policy (EP, RR, EP_RR or MLFQ) with a
+//fresh memory manager, left as the run ended for its statistics. The
+//default quantum has its own RR and EP_RR engines with the quantum built
+//in. With a `stream`, `processes` is empty and the stream feeds them as
+//they arrive. Returns false for an unknown policy, or a resume snapshot
+//that does not match this build
+inline bool run_simulation(const std::string &policy, const pcb_table &processes,
+                           memory_manager &memory, exec_sink &sink,
+                           const sim_options &options = sim_options(),
+                           workload_stream *stream = nullptr) {
+    if (policy == "EP") {
+        return run_policy<EP_policy>(processes, memory, sink, options, stream);
+    } else if (policy == "RR" && options.quantum == TIME_QUANTUM) {
+        return run_policy<RR_policy<>>(processes, memory, sink, options, stream);
+    } else if (policy == "RR") {
+        return run_policy<RR_policy<VARIABLE_QUANTUM>>(processes, memory, sink, options, stream);
+    } else if (policy == "EP_RR" && options.quantum == TIME_QUANTUM) {
+        return run_policy<EP_RR_policy<>>(processes, memory, sink, options, stream);
+    } else if (policy == "EP_RR") {
+        return run_policy<EP_RR_policy<VARIABLE_QUANTUM>>(processes, memory, sink, options, stream);
+    } else if (policy == "MLFQ") {
+        return run_policy<MLFQ_policy>(processes, memory, sink, options, stream);
+    }
+    return false;
+}
+
+//------------------------------ COMMAND LINE ---------------------------------
+
+//Entry point shared by the simulator binaries. `default_policy` is used when
+//no --policy option is given; if it is null the option is required
+inline int simulator_main(int argc, char** argv, const char *default_policy) {
+
+    std::string program = argv[0];
+    program = program.substr(program.find_last_of('/') + 1);
+
+    if(argc < 2 || argc > 22) {
+        std::cout << "ERROR!\nExpected 1 to 21 arguments, received "
+                  << argc - 1 << std::endl;
+        std::cout << "To run the program, do: ./" << program
+                  << " <input_file.txt|-> " << (default_policy ? "[" : "")
+                  << "--policy=EP|RR|EP_RR|MLFQ" << (default_policy ? "]" : "")
+                  << " [--config=<run.conf>] [--engine=event|tick] [--cpus=N]"
+                     " [--quantum=MS] [--mlfq-quanta=Q0,Q1,...]"
+                     " [--mlfq-boost=MS] [--switch-cost=MS] [--scheduler-cost=MS]"
+                     " [--interrupt-cost=MS] [--stop=all|admitted] [--format=table|bin|none]"
+                     " [--metrics[=text|json]] [--memory=<config.txt>]"
+                     " [--memory-stats] [--profile[=<profile.json>]]"
+                     " [--checkpoint[=<file>]] [--checkpoint-every=S] [--resume]"
+                     " [--stream]" << std::endl;
+        return -1;
+    }
+
+    std::string policy = default_policy ? default_policy : "";
+    sim_options options;
+    std::string format = "table";      // table, bin or none
+    std::string metrics;               // empty (no summary), text or json
+    std::string memory_file;           // empty for the default partitions
+    bool memory_stats = false;
+    bool profile = false;
+    std::string profile_file;          // empty for a text profile on stderr
+    bool checkpoint = false;
+    std::string checkpoint_file;       // empty for output_files/checkpoint_<policy>.bin
+    bool resume = false;
+    bool stream = false;               // read the input while the run goes (- for stdin)
+    std::string error;
+    // options apply in order, so --config=... --quantum=50 overrides the file
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        if (option.rfind("--policy=", 0) == 0 && is_policy(option.substr(9))) {
+            policy = option.substr(9);
+        } else if (option.rfind("--config=", 0) == 0) {
+            if (!load_sim_config(option.substr(9).c_str(), options, error)) {
+                std::cerr << "Error: " << error << std::endl;
+                return -1;
+            }
+        } else if (is_sim_option(option)) {
+            error = set_sim_option(option, options);
+            if (!error.empty()) {
+                std::cerr << "Error: " << error << std::endl;
+                return -1;
+            }
+        } else if (option == "--format=table" || option == "--format=bin" ||
+                   option == "--format=none") {
+            format = option.substr(9);
+        } else if (option == "--metrics" || option == "--metrics=text") {
+            metrics = "text";
+        } else if (option == "--metrics=json") {
+            metrics = "json";
+        } else if (option.rfind("--memory=", 0) == 0) {
+            memory_file = option.substr(9);
+        } else if (option == "--memory-stats") {
+            memory_stats = true;
+        } else if (option == "--profile" || option.rfind("--profile=", 0) == 0) {
+            if (!SIM_INSTRUMENTATION) {
+                std::cerr << "Error: --profile needs a build with SIM_INSTRUMENTATION=1"
+                             " (cmake -DENABLE_INSTRUMENTATION=ON)" << std::endl;
+                return -1;
+            }
+            profile = true;
+            profile_file = option.size() > 10 ? option.substr(10) : "";
+        } else if (option == "--checkpoint" || option.rfind("--checkpoint=", 0) == 0) {
+            checkpoint = true;
+            checkpoint_file = option.size() > 13 ? option.substr(13) : "";
+        } else if (option.rfind("--checkpoint-every=", 0) == 0) {
+            // 0 s would snapshot on every clock read, a rate nobody means
+            if (!parse_time(option.substr(19), options.checkpoint_every) ||
+                options.checkpoint_every == 0) {
+                std::cerr << "Error: Invalid checkpoint interval: " << option.substr(19)
+                          << std::endl;
+                return -1;
+            }
+            checkpoint = true;
+        } else if (option == "--resume") {
+            resume = true;
+        } else if (option == "--stream") {
+            stream = true;
+        } else {
+            std::cerr << "Error: Unknown option: " << option << std::endl;
+            return -1;
+        }
+    }
+    if (policy.empty()) {
+        std::cerr << "Error: Missing --policy=EP|RR|EP_RR|MLFQ" << std::endl;
+        return -1;
+    }
+
+    if (stream && (checkpoint || resume)) {
+        // a checkpoint would need the input it was taken from, read again
+        std::cerr << "Error: --stream runs cannot be checkpointed" << std::endl;
+        return -1;
+    }
+
+    auto file_name = argv[1];
+    pcb_table list_process;
+    std::unique_ptr<workload_stream> input;
+    if (stream) {
+        input.reset(new workload_stream(file_name));
+        if (!input->is_open()) {
+            std::cerr << "Error: Unable to open file: " << file_name << std::endl;
+            return -1;
+        }
+    } else if (!load_workload(file_name, list_process, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return -1;
+    }
+
+    memory_config memory_layout;
+    if (!memory_file.empty() &&
+        !load_memory_config(memory_file.c_str(), memory_layout, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return -1;
+    }
+
+    // A resumed run needs the checkpoint of this very run, and carries on
+    // writing the log where the checkpoint left it
+    if (checkpoint || resume) {
+        options.checkpoint_file = !checkpoint_file.empty() ? checkpoint_file
+                                : "output_files/checkpoint_" + policy + ".bin";
+        options.checkpoint_key = checkpoint_key(policy, format, list_process,
+                                                options, memory_layout);
+    }
+    if (resume) {
+        if (!read_checkpoint(options.checkpoint_file, options.checkpoint_key,
+                             options.resume_snapshot, error)) {
+            std::cerr << "Error: " << error << std::endl;
+            return -1;
+        }
+    }
+
+    std::string output_name = "output_files/execution_" + policy +
+                              (format == "bin" ? ".bin" : ".txt");
+    std::ofstream output_file;
+    std::unique_ptr<exec_sink> log;
+    if (format != "none") {
+        output_file.open(output_name, resume ? std::ios::binary | std::ios::in | std::ios::out
+                                             : std::ios::binary);
+        if (!output_file.is_open()) {
+            std::cerr << "Error opening file!" << std::endl;
+            return -1;
+        }
+        if (format == "bin") {
+            log.reset(new binary_sink(output_file, options.cpus > 1));
+        } else {
+            log.reset(new table_sink(output_file, options.cpus > 1));
+        }
+    }
+
+    // metrics are computed from the transitions on their way to the log
+    exec_sink *output = log.get();
+    profiled_sink timed_output(output);
+    if (SIM_INSTRUMENTATION && output) output = &timed_output;
+    metrics_sink sink(output, options.cpus);
+    std::unique_ptr<memory_manager> memory = make_memory_manager(memory_layout);
+    if (!run_simulation(policy, list_process, *memory, sink, options, input.get())) {
+        // the policy was checked above, so the checkpoint is the problem
+        std::cerr << "Error: " << CHECKPOINT_MISMATCH << std::endl;
+        return -1;
+    }
+
+    if (log) {
+        // the log of a resumed run may end before the interrupted one did
+        std::streamoff output_size = output_file.tellp();
+        output_file.close();
+        std::error_code ignored;
+        if (resume) std::filesystem::resize_file(output_name, output_size, ignored);
+        std::cout << "File content overwritten successfully." << std::endl;
+        std::cout << "Output generated in " << output_name << std::endl;
+    }
+
+    if (input && !input->error().empty()) {
+        // the run stopped reading there, what came before it is complete
+        std::cerr << "Error: " << input->error() << std::endl;
+        return -1;
+    }
+
+    if (!options.checkpoint_file.empty()) {
+        // the run is complete, with any write a kill interrupted
+        std::remove(options.checkpoint_file.c_str());
+        std::remove((options.checkpoint_file + ".tmp").c_str());
+    }
+
+    if (metrics == "text") {
+        print_metrics(std::cout, file_name, sink.result());
+    } else if (metrics == "json") {
+        print_metrics_json(std::cout, file_name, sink.result());
+    }
+    if (memory_stats) {
+        print_memory_stats(std::cout, file_name, memory_layout.allocator,
+                           memory->stats());
+    }
+    if (profile && profile_file.empty()) {
+        print_profile(std::cerr, file_name, policy, current_profile());
+    } else if (profile) {
+        std::ofstream profile_output(profile_file);
+        if (!profile_output.is_open()) {
+            std::cerr << "Error opening file!" << std::endl;
+            return -1;
+        }
+        print_profile_json(profile_output, file_name, policy, current_profile());
+    }
+
+    return 0;
+}
+
+#endif  // SIMULATOR_101258593_HPP_
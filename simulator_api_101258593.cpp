@@ -0,0 +1,78 @@
+#include "simulator_api_101258593.hpp"
+
+// The Simulator of simulator_api_101258593.hpp: every engine is instantiated
+// here, once, for the programs linking the simulator library
+
+Simulator::Simulator(pcb_table workload, std::string policy,
+                     memory_config memory, sim_options options)
+    : processes(std::move(workload)), policy_name(std::move(policy)),
+      layout(std::move(memory)), settings(std::move(options)) {}
+
+bool Simulator::load(const std::string &file_name, pcb_table &workload,
+                     std::string &error) {
+    return load_workload(file_name.c_str(), workload, error);
+}
+
+std::string Simulator::check() const {
+    if (!is_policy(policy_name)) {
+        return "unknown policy '" + policy_name + "'";
+    }
+    if (!is_allocator(layout.allocator)) {
+        return "unknown allocator '" + layout.allocator + "'";
+    }
+    if (layout.allocator.rfind("fixed-", 0) == 0 && layout.partitions.empty()) {
+        return "no partitions for " + layout.allocator;
+    }
+    if (layout.allocator == "buddy" && layout.min_block == 0) {
+        return "invalid min_block 0";
+    }
+    if (settings.cpus < 1 || settings.cpus > MAX_CPUS) {
+        return "invalid cpus " + std::to_string(settings.cpus);
+    }
+    if (settings.quantum == 0 || settings.quantum == VARIABLE_QUANTUM) {
+        return "invalid quantum " + std::to_string(settings.quantum);
+    }
+    if (settings.mlfq_quanta.empty() || settings.mlfq_quanta.size() > MAX_MLFQ_LEVELS) {
+        return "MLFQ needs 1 to " + std::to_string(MAX_MLFQ_LEVELS) + " quanta";
+    }
+    for (unsigned int quantum : settings.mlfq_quanta) {
+        if (quantum == 0) return "invalid MLFQ quantum 0";
+    }
+    if (!settings.checkpoint_file.empty() && settings.checkpoint_every == 0) {
+        return "invalid checkpoint_every 0";
+    }
+    // as parse_process_line does for a workload built without it
+    for (pcb_handle handle = 0; handle < processes.size(); handle++) {
+        if (processes.info(handle).processing_time == 0) {
+            return "PID " + std::to_string(processes[handle].PID) + ": invalid burst time '0'";
+        }
+    }
+    return "";
+}
+
+bool Simulator::run(exec_sink *observer) {
+    run_error = check();
+    if (!run_error.empty()) return false;
+
+    metrics_sink sink(observer, settings.cpus);
+    if (!processes.empty()) {
+        // the usual dense PIDs get a flat table; only sparse ones a node each
+        int first = processes[0].PID, last = first;
+        for (pcb_handle handle = 1; handle < processes.size(); handle++) {
+            first = std::min(first, processes[handle].PID);
+            last = std::max(last, processes[handle].PID);
+        }
+        if ((static_cast<long long>(last) - first) / 4 < static_cast<long long>(processes.size())) {
+            sink.index_pids(first, last);
+        }
+    }
+    std::unique_ptr<memory_manager> manager = make_memory_manager(layout);
+    if (!run_simulation(policy_name, processes, *manager, sink, settings)) {
+        // check() passed, so the resume snapshot is the problem
+        run_error = CHECKPOINT_MISMATCH;
+        return false;
+    }
+    run_metrics = sink.result();
+    run_memory = manager->stats();
+    return true;
+}
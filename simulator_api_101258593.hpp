@@ -0,0 +1,151 @@
+/**
+ * @file simulator_api_101258593.hpp
+ * @brief The simulator as a library, for programs that embed it
+ * @author 101258593
+ *
+ * A Simulator runs a workload under one policy and memory config and hands
+ * every state transition to an observer as it happens: either an exec_sink
+ * of the caller's (one virtual call per transition, nothing formatted), or
+ * a transition_ring drained by another thread. The metrics of a workload
+ * with dense PIDs are kept in a table sized before the run, so handing a
+ * transition to the observer does not allocate. The run itself still does:
+ * its queues and the buckets of the I/O wait wheel allocate as they first
+ * grow to their largest size (logarithmically in that size, once per
+ * run), and the memory managers allocate nodes of their free-block
+ * indexes on every admission and release (one for fixed partitions, a few
+ * for variable ones). Link the simulator_101258593 library target, which
+ * instantiates the engines once.
+ *
+ *  Simulator simulator(workload, "RR", memory_config(), options);
+ *  if (!simulator.run(&observer)) std::cerr << simulator.error();
+ *  simulator.metrics().avg_wait_time, simulator.memory().peak_used
+ */
+
+#ifndef SIMULATOR_API_101258593_HPP_
+#define SIMULATOR_API_101258593_HPP_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "interrupts_101258593.hpp"
+#include "memory_101258593.hpp"
+#include "simulator_101258593.hpp"
+
+class Simulator {
+public:
+    //`policy` is EP, RR, EP_RR or MLFQ; they are checked by run
+    Simulator(pcb_table workload, std::string policy,
+              memory_config memory = memory_config(),
+              sim_options options = sim_options());
+
+    //Reads a workload in the input file format. Returns false with a
+    //"file:line: message" error for the first malformed line
+    static bool load(const std::string &file_name, pcb_table &workload,
+                     std::string &error);
+
+    //Runs the workload from time 0 with a fresh memory manager, handing
+    //each transition to `observer` (if any) and then finish(). Returns
+    //false with error() if the policy, memory config or options are
+    //invalid, or options.resume_snapshot does not match this build. Can
+    //be called again; the results are those of the last run
+    bool run(exec_sink *observer = nullptr);
+
+    const sim_metrics &metrics() const { return run_metrics; }
+    const memory_stats &memory() const { return run_memory; }
+    const std::string &error() const { return run_error; }
+
+    const pcb_table &workload() const { return processes; }
+    const std::string &policy() const { return policy_name; }
+    const memory_config &memory_layout() const { return layout; }
+    const sim_options &options() const { return settings; }
+
+private:
+    //Empty if the run can start, else why not
+    std::string check() const;
+
+    pcb_table       processes;
+    std::string     policy_name;
+    memory_config   layout;
+    sim_options     settings;
+
+    sim_metrics     run_metrics;
+    memory_stats    run_memory;
+    std::string     run_error;
+};
+
+//One state transition, as handed to exec_sink::transition
+struct sim_transition{
+    unsigned int    time;
+    int             PID;
+    unsigned int    cpu;
+    states          old_state;
+    states          new_state;
+};
+
+//A fixed-size ring of transitions between a run on one thread (the ring is
+//its observer) and a consumer on another, which pops until done(). The run
+//waits while the ring is full, so no transition is dropped; on a single
+//thread, observe with an exec_sink instead. Nothing is allocated after
+//construction
+class transition_ring : public exec_sink {
+public:
+    //`capacity` is rounded up to a power of two
+    explicit transition_ring(std::size_t capacity = 4096)
+        : slots(round_up(capacity)), mask(slots.size() - 1) {}
+
+    void transition(unsigned int current_time, int PID,
+                    states old_state, states new_state,
+                    unsigned int cpu) override {
+        std::size_t tail = written.load(std::memory_order_relaxed);
+        while (tail - taken.load(std::memory_order_acquire) == slots.size()) {
+            std::this_thread::yield();
+        }
+        slots[tail & mask] = {current_time, PID, cpu, old_state, new_state};
+        written.store(tail + 1, std::memory_order_release);
+    }
+
+    void finish() override { finished.store(true, std::memory_order_release); }
+
+    //Takes the oldest transition. False if there is none yet
+    bool pop(sim_transition &transition) {
+        std::size_t head = taken.load(std::memory_order_relaxed);
+        if (head == written.load(std::memory_order_acquire)) return false;
+        transition = slots[head & mask];
+        taken.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    //True once the run has finished and its last transition was popped
+    bool done() const {
+        return finished.load(std::memory_order_acquire) &&
+               taken.load(std::memory_order_relaxed) == written.load(std::memory_order_acquire);
+    }
+
+    //Empties the ring for another run; neither side may be using it
+    void reset() {
+        written.store(0);
+        taken.store(0);
+        finished.store(false);
+    }
+
+    std::size_t capacity() const { return slots.size(); }
+
+private:
+    static std::size_t round_up(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+
+    std::vector<sim_transition>         slots;
+    std::size_t                         mask;
+    // producer and consumer indices on their own cache lines
+    alignas(64) std::atomic<std::size_t> written{0};
+    alignas(64) std::atomic<std::size_t> taken{0};
+    std::atomic<bool>                   finished{false};
+};
+
+#endif  // SIMULATOR_API_101258593_HPP_
@@ -0,0 +1,226 @@
+/**
+ * @file snapshot_101258593.hpp
+ * @brief Binary snapshots of simulator state, for checkpoints of long runs
+ * @author 101258593
+ *
+ * Every stateful part of a run (PCB table, queues, CPUs, memory manager,
+ * sinks) saves itself to a snapshot_writer and restores itself from a
+ * snapshot_reader, field by field in host byte order: a checkpoint is only
+ * read back by the same build that wrote it. The checkpoint file wraps the
+ * snapshot in a header naming the run it belongs to and a checksum.
+ *
+ *  header, 20 bytes: magic "A3CK", uint32 version, uint64 run key, uint32 reserved
+ *  payload         : the snapshot
+ *  trailer, 8 bytes: uint64 FNV-1a hash of the payload
+ */
+
+#ifndef SNAPSHOT_101258593_HPP_
+#define SNAPSHOT_101258593_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+const char          CHECKPOINT_MAGIC[4] = {'A', '3', 'C', 'K'};
+const std::uint32_t CHECKPOINT_VERSION  = 1;
+
+//64-bit FNV-1a, chained through `hash`
+inline std::uint64_t fnv1a(const void *data, std::size_t size,
+                           std::uint64_t hash = 14695981039346656037ull) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+class snapshot_writer {
+public:
+    explicit snapshot_writer(std::ostream &out) : out(out) {}
+
+    template <typename T>
+    void put(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw bytes only");
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void put(const std::vector<T> &values) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw bytes only");
+        put<std::uint64_t>(values.size());
+        out.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(T));
+    }
+
+    template <typename A, typename B>
+    void put(const std::pair<A, B> &pair) {
+        put(pair.first);
+        put(pair.second);
+    }
+
+    template <typename T>
+    void put(const std::set<T> &values) {
+        put<std::uint64_t>(values.size());
+        for (const T &value : values) put(value);
+    }
+
+    template <typename K, typename V>
+    void put(const std::map<K, V> &values) {
+        put<std::uint64_t>(values.size());
+        for (const auto &entry : values) put(entry);
+    }
+
+private:
+    std::ostream &out;
+};
+
+//Reads what snapshot_writer wrote, in the same order. After a short or
+//inconsistent read ok() is false and every value read is zero
+class snapshot_reader {
+public:
+    explicit snapshot_reader(const std::string &data) : pos(data.data()), end(pos + data.size()) {}
+
+    bool ok() const { return good; }
+    bool at_end() const { return pos == end; }
+
+    template <typename T>
+    void get(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw bytes only");
+        if (!take(&value, sizeof(T))) std::memset(static_cast<void *>(&value), 0, sizeof(T));
+    }
+
+    template <typename T>
+    void get(std::vector<T> &values) {
+        static_assert(std::is_trivially_copyable<T>::value, "raw bytes only");
+        std::uint64_t count = get_count(sizeof(T));
+        values.resize(count);
+        if (!take(values.data(), count * sizeof(T))) values.clear();
+    }
+
+    template <typename A, typename B>
+    void get(std::pair<A, B> &pair) {
+        get(pair.first);
+        get(pair.second);
+    }
+
+    template <typename T>
+    void get(std::set<T> &values) {
+        values.clear();
+        for (std::uint64_t count = get_count(sizeof(T)); count > 0 && good; count--) {
+            T value;
+            get(value);
+            values.insert(values.end(), value);
+        }
+    }
+
+    template <typename K, typename V>
+    void get(std::map<K, V> &values) {
+        values.clear();
+        for (std::uint64_t count = get_count(sizeof(K) + sizeof(V)); count > 0 && good; count--) {
+            std::pair<K, V> entry;
+            get(entry);
+            values.insert(values.end(), entry);
+        }
+    }
+
+    //Marks the snapshot inconsistent, for checks of the values read
+    void fail() { good = false; }
+
+private:
+    bool take(void *value, std::size_t size) {
+        if (!good || std::size_t(end - pos) < size) {
+            good = false;
+            return false;
+        }
+        std::memcpy(value, pos, size);
+        pos += size;
+        return true;
+    }
+
+    //A count of elements of at least `element_size` bytes that can all be there
+    std::uint64_t get_count(std::size_t element_size) {
+        std::uint64_t count = 0;
+        get(count);
+        if (element_size > 0 && count > std::uint64_t(end - pos) / element_size) {
+            good = false;
+            return 0;
+        }
+        return count;
+    }
+
+    const char  *pos;
+    const char  *end;
+    bool        good = true;
+};
+
+//Writes a checkpoint of `payload` for the run `key`. The file is written
+//next to `file_name` first and renamed over it, so a crash mid-write
+//leaves the previous checkpoint in place
+inline bool write_checkpoint(const std::string &file_name, std::uint64_t key,
+                             const std::string &payload) {
+    std::string temporary = file_name + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        std::uint32_t reserved = 0;
+        std::uint64_t hash = fnv1a(payload.data(), payload.size());
+        out.write(CHECKPOINT_MAGIC, 4);
+        out.write(reinterpret_cast<const char *>(&CHECKPOINT_VERSION), 4);
+        out.write(reinterpret_cast<const char *>(&key), 8);
+        out.write(reinterpret_cast<const char *>(&reserved), 4);
+        out.write(payload.data(), payload.size());
+        out.write(reinterpret_cast<const char *>(&hash), 8);
+        out.flush();
+        if (!out) return false;
+    }
+    return std::rename(temporary.c_str(), file_name.c_str()) == 0;
+}
+
+//Reads the payload of a checkpoint written for the run `key`. Returns false
+//with an error if the file is missing, damaged or from another run
+inline bool read_checkpoint(const std::string &file_name, std::uint64_t key,
+                            std::string &payload, std::string &error) {
+    std::ifstream in(file_name, std::ios::binary);
+    if (!in.is_open()) {
+        error = "Unable to open checkpoint: " + file_name;
+        return false;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    std::string data = contents.str();
+
+    const std::size_t header = 20, trailer = 8;
+    std::uint32_t version = 0;
+    std::uint64_t file_key = 0, hash = 0;
+    if (data.size() < header + trailer || data.compare(0, 4, CHECKPOINT_MAGIC, 4) != 0) {
+        error = file_name + " is not a checkpoint";
+        return false;
+    }
+    std::memcpy(&version, data.data() + 4, 4);
+    std::memcpy(&file_key, data.data() + 8, 8);
+    std::memcpy(&hash, data.data() + data.size() - trailer, 8);
+    if (version != CHECKPOINT_VERSION) {
+        error = file_name + ": unsupported checkpoint version " + std::to_string(version);
+        return false;
+    }
+    if (file_key != key) {
+        error = file_name + " is a checkpoint of another input, policy or options";
+        return false;
+    }
+
+    payload = data.substr(header, data.size() - header - trailer);
+    if (fnv1a(payload.data(), payload.size()) != hash) {
+        error = file_name + " is damaged (checksum mismatch)";
+        return false;
+    }
+    return true;
+}
+
+#endif  // SNAPSHOT_101258593_HPP_
@@ -0,0 +1,406 @@
+/**
+ * @file sweep_101258593.hpp
+ * @brief Sweep mode: one workload under a grid of policies and run options
+ * @author 101258593
+ *
+ * The workload is parsed once and shared read-only by every run of the
+ * grid. The runs go through the batch thread pool and keep only their
+ * metrics, with no execution log. The report gives the best configuration
+ * for each objective and the Pareto front of turnaround against response,
+ * among the runs that finished the most processes: averages over fewer
+ * processes (--stop=admitted) are not comparable with them.
+ */
+
+#ifndef SWEEP_101258593_HPP_
+#define SWEEP_101258593_HPP_
+
+#include <limits>
+
+#include "batch_101258593.hpp"
+
+//Run options a sweep can take a list or range of values for
+const char *const SWEEP_KEYS[] = {
+    "quantum", "cpus", "switch_cost", "scheduler_cost", "interrupt_cost", "mlfq_boost"
+};
+const std::size_t MAX_SWEEP_RUNS = 100000;
+
+//True if the run option `key` changes the runs of `policy`
+inline bool sweep_applies(const std::string &policy, const std::string &key) {
+    if (key == "quantum") return policy == "RR" || policy == "EP_RR";
+    if (key == "mlfq_boost") return policy == "MLFQ";
+    return true;
+}
+
+//Expands one item of a sweep list: a value, or "LOW:HIGH[:STEP]" (STEP
+//defaults to 1) for every value from LOW to HIGH
+inline bool parse_sweep_range(const std::string &item, std::vector<std::string> &values) {
+    std::size_t first = item.find(':');
+    if (first == std::string::npos) {
+        values.push_back(item);
+        return true;
+    }
+
+    auto number = [](const std::string &digits, unsigned long long &value) {
+        const char *end = digits.data() + digits.size();
+        auto [next, ec] = std::from_chars(digits.data(), end, value);
+        return ec == std::errc() && next == end && !digits.empty();
+    };
+    std::size_t second = item.find(':', first + 1);
+    unsigned long long range[3] = {0, 0, 1};     // low, high, step
+    if (!number(item.substr(0, first), range[0]) ||
+        !number(item.substr(first + 1, second - first - 1), range[1]) ||
+        (second != std::string::npos && !number(item.substr(second + 1), range[2]))) {
+        return false;
+    }
+    if (range[2] == 0 || range[0] > range[1] ||
+        (range[1] - range[0]) / range[2] >= MAX_SWEEP_RUNS) {
+        return false;
+    }
+    for (unsigned long long value = range[0]; value <= range[1]; value += range[2]) {
+        values.push_back(std::to_string(value));
+    }
+    return true;
+}
+
+//Expands a comma-separated list of values and ranges, "10,25,50:200:50"
+inline bool parse_sweep_values(const std::string &list, std::vector<std::string> &values) {
+    values.clear();
+    std::size_t start = 0;
+    while (start <= list.size()) {
+        std::size_t comma = std::min(list.find(',', start), list.size());
+        if (!parse_sweep_range(list.substr(start, comma - start), values)) return false;
+        start = comma + 1;
+    }
+    return values.size() <= MAX_SWEEP_RUNS;
+}
+
+//One run option and the values it is swept over
+struct sweep_axis{
+    std::string                 key;
+    std::vector<std::string>    values;
+};
+
+//One run of the grid
+struct sweep_point{
+    std::string                 policy;
+    std::vector<std::string>    values;    // per axis, "-" if it does not apply to the policy
+    sim_options                 options;
+    sim_metrics                 metrics;
+    bool                        complete = true;    // finished as many processes as any run
+    bool                        pareto = false;
+};
+
+//Every point of policies x axes, in order. An axis that does not apply to
+//a policy keeps the base value, once. Returns false with an error for an
+//invalid value or a grid of more than MAX_SWEEP_RUNS runs
+inline bool make_sweep_grid(const std::vector<std::string> &policies,
+                            const std::vector<sweep_axis> &axes,
+                            const sim_options &base,
+                            std::vector<sweep_point> &points, std::string &error) {
+    points.clear();
+    for (const std::string &policy : policies) {
+        std::vector<sweep_point> grid(1);
+        grid[0].policy = policy;
+        grid[0].options = base;
+        for (const sweep_axis &axis : axes) {
+            if (!sweep_applies(policy, axis.key)) {
+                for (sweep_point &point : grid) point.values.push_back("-");
+                continue;
+            }
+            if (grid.size() * axis.values.size() > MAX_SWEEP_RUNS) {
+                error = "More than " + std::to_string(MAX_SWEEP_RUNS) + " runs to sweep";
+                return false;
+            }
+            std::vector<sweep_point> expanded;
+            for (const sweep_point &point : grid) {
+                for (const std::string &value : axis.values) {
+                    sweep_point next = point;
+                    error = set_sim_option(axis.key, value, next.options);
+                    if (!error.empty()) return false;
+                    next.values.push_back(value);
+                    expanded.push_back(next);
+                }
+            }
+            grid.swap(expanded);
+        }
+        points.insert(points.end(), grid.begin(), grid.end());
+        if (points.size() > MAX_SWEEP_RUNS) {
+            error = "More than " + std::to_string(MAX_SWEEP_RUNS) + " runs to sweep";
+            return false;
+        }
+    }
+    return true;
+}
+
+//Runs every point on `workers` threads, each with its own memory manager
+inline void run_sweep(const pcb_table &processes, const memory_config &memory,
+                      std::vector<sweep_point> &points, unsigned int workers) {
+    parallel_for(points.size(), workers, [&](std::size_t i) {
+        sweep_point &point = points[i];
+        metrics_sink sink(nullptr, point.options.cpus);
+        std::unique_ptr<memory_manager> manager = make_memory_manager(memory);
+        run_simulation(point.policy, processes, *manager, sink, point.options);
+        point.metrics = sink.result();
+    });
+}
+
+//Marks the points that finished fewer processes than another one as not
+//complete. Returns how many there are
+inline std::size_t mark_complete(std::vector<sweep_point> &points) {
+    unsigned int most = 0;
+    for (const sweep_point &point : points) most = std::max(most, point.metrics.processes);
+    std::size_t incomplete = 0;
+    for (sweep_point &point : points) {
+        point.complete = point.metrics.processes == most;
+        incomplete += !point.complete;
+    }
+    return incomplete;
+}
+
+//Marks the complete points that no other one beats on both average turnaround
+//and average response time (lower is better for both). In order of
+//turnaround, a point is on the front if it has the lowest response of
+//its turnaround and beats every point of a lower turnaround: O(n log n)
+inline void mark_pareto(std::vector<sweep_point> &points) {
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < points.size(); i++) {
+        if (points[i].complete) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        const sim_metrics &x = points[a].metrics, &y = points[b].metrics;
+        return x.avg_turnaround < y.avg_turnaround ||
+               (x.avg_turnaround == y.avg_turnaround && x.avg_response < y.avg_response);
+    });
+
+    double best_response = std::numeric_limits<double>::infinity();   // of lower turnarounds
+    for (std::size_t first = 0, last; first < order.size(); first = last) {
+        const sim_metrics &lowest = points[order[first]].metrics;
+        for (last = first; last < order.size() &&
+             points[order[last]].metrics.avg_turnaround == lowest.avg_turnaround; last++) {
+            points[order[last]].pareto =
+                points[order[last]].metrics.avg_response == lowest.avg_response &&
+                lowest.avg_response < best_response;
+        }
+        best_response = std::min(best_response, lowest.avg_response);
+    }
+}
+
+//"RR quantum=50 cpus=2", leaving out the axes that do not apply
+inline std::string sweep_config(const sweep_point &point,
+                                const std::vector<sweep_axis> &axes) {
+    std::string config = point.policy;
+    for (std::size_t i = 0; i < axes.size(); i++) {
+        if (point.values[i] != "-") config += " " + axes[i].key + "=" + point.values[i];
+    }
+    return config;
+}
+
+inline double overhead_share(const sim_metrics &metrics) {
+    unsigned long long total = metrics.cpu.useful + metrics.cpu.overhead();
+    return total ? 100.0 * metrics.cpu.overhead() / total : 0.0;
+}
+
+//Best complete configuration for each objective, then the Pareto front by
+//turnaround
+inline void print_sweep(std::ostream &out, const std::string &input,
+                        const std::vector<sweep_axis> &axes,
+                        const std::vector<sweep_point> &points) {
+    if (points.empty()) return;
+    const sweep_point *first = &points[0];
+    std::size_t incomplete = 0;
+    for (const sweep_point &point : points) {
+        if (!point.complete) incomplete++;
+        if (!first->complete) first = &point;
+    }
+    auto best = [&](auto better) {
+        const sweep_point *chosen = first;
+        for (const sweep_point &point : points) {
+            if (point.complete && better(point.metrics, chosen->metrics)) chosen = &point;
+        }
+        return chosen;
+    };
+    const sweep_point *turnaround = best([](const sim_metrics &a, const sim_metrics &b) {
+        return a.avg_turnaround < b.avg_turnaround; });
+    const sweep_point *response = best([](const sim_metrics &a, const sim_metrics &b) {
+        return a.avg_response < b.avg_response; });
+    const sweep_point *wait = best([](const sim_metrics &a, const sim_metrics &b) {
+        return a.avg_wait_time < b.avg_wait_time; });
+    const sweep_point *throughput = best([](const sim_metrics &a, const sim_metrics &b) {
+        return a.throughput > b.throughput; });
+
+    out << std::fixed << std::setprecision(2)
+        << "\n===== Sweep of " << input << " (" << points.size() << " runs) =====\n"
+        << "Best avg turnaround: " << sweep_config(*turnaround, axes)
+        << " (" << turnaround->metrics.avg_turnaround << " ms)\n"
+        << "Best avg response:   " << sweep_config(*response, axes)
+        << " (" << response->metrics.avg_response << " ms)\n"
+        << "Best avg wait:       " << sweep_config(*wait, axes)
+        << " (" << wait->metrics.avg_wait_time << " ms)\n"
+        << "Best throughput:     " << sweep_config(*throughput, axes)
+        << " (" << std::setprecision(4) << throughput->metrics.throughput
+        << " processes/ms)\n";
+    if (incomplete > 0) {
+        out << "Left out:            " << incomplete << " runs that finished fewer than "
+            << first->metrics.processes << " processes\n";
+    }
+
+    std::vector<const sweep_point *> front;
+    for (const sweep_point &point : points) {
+        if (point.pareto) front.push_back(&point);
+    }
+    std::stable_sort(front.begin(), front.end(), [](const sweep_point *a, const sweep_point *b) {
+        return a->metrics.avg_turnaround < b->metrics.avg_turnaround;
+    });
+
+    std::vector<std::size_t> widths;
+    out << "\nPareto front, avg turnaround vs avg response (" << front.size() << " runs)\n"
+        << "Policy";
+    for (const sweep_axis &axis : axes) {
+        std::size_t width = axis.key.size();
+        for (const std::string &value : axis.values) width = std::max(width, value.size());
+        widths.push_back(width);
+        out << " | " << std::setw(width) << axis.key;
+    }
+    out << " | Throughput | Avg Wait | Avg Turnaround | Avg Response | Overhead\n";
+    for (const sweep_point *point : front) {
+        out << std::setw(6) << point->policy;
+        for (std::size_t i = 0; i < axes.size(); i++) {
+            out << " | " << std::setw(widths[i]) << point->values[i];
+        }
+        const sim_metrics &metrics = point->metrics;
+        out << " | " << std::setw(10) << std::setprecision(4) << metrics.throughput
+            << " | " << std::setw(8) << std::setprecision(2) << metrics.avg_wait_time
+            << " | " << std::setw(14) << metrics.avg_turnaround
+            << " | " << std::setw(12) << metrics.avg_response
+            << " | " << std::setw(7) << std::setprecision(1) << overhead_share(metrics) << "%\n";
+    }
+    out.unsetf(std::ios::floatfield);
+    out << std::flush;
+}
+
+//One JSON object per run, in grid order
+inline void print_sweep_json(std::ostream &out, const std::string &input,
+                             const std::vector<sweep_axis> &axes,
+                             const std::vector<sweep_point> &points) {
+    for (const sweep_point &point : points) {
+        out << std::setprecision(10)
+            << "{\"input\": " << json_string(input) << ", \"policy\": \"" << point.policy << "\"";
+        for (std::size_t i = 0; i < axes.size(); i++) {
+            if (point.values[i] != "-") out << ", \"" << axes[i].key << "\": " << point.values[i];
+        }
+        const sim_metrics &metrics = point.metrics;
+        out << ", \"processes\": " << metrics.processes
+            << ", \"complete\": " << (point.complete ? "true" : "false")
+            << ", \"throughput\": " << metrics.throughput
+            << ", \"avg_wait_time\": " << metrics.avg_wait_time
+            << ", \"avg_turnaround\": " << metrics.avg_turnaround
+            << ", \"avg_response\": " << metrics.avg_response
+            << ", \"overhead_time\": " << metrics.cpu.overhead()
+            << ", \"pareto\": " << (point.pareto ? "true" : "false") << "}" << std::endl;
+    }
+}
+
+//Entry point of `--sweep`: argv[1] is "--sweep", argv[2] the workload, the
+//other arguments options. A sweep key given a list or range becomes an
+//axis of the grid, any other run option applies to every run
+inline int sweep_main(int argc, char** argv) {
+
+    if (argc < 3) {
+        std::string program = argv[0];
+        program = program.substr(program.find_last_of('/') + 1);
+        std::cout << "To run a sweep, do: ./" << program
+                  << " --sweep <input_file.txt> [--policy=EP,RR,EP_RR,MLFQ] [--jobs=N]"
+                     " [--quantum=Q1,Q2,...|LOW:HIGH[:STEP]] [--cpus=...]"
+                     " [--switch-cost=...] [--scheduler-cost=...] [--interrupt-cost=...]"
+                     " [--mlfq-boost=...] [--config=<run.conf>] [--engine=event|tick]"
+                     " [--mlfq-quanta=Q0,Q1,...] [--stop=all|admitted] [--memory=<config.txt>]"
+                     " [--metrics[=text|json]]" << std::endl;
+        return -1;
+    }
+
+    std::string input = argv[2];
+    std::vector<std::string> policies;
+    unsigned int workers = std::thread::hardware_concurrency();
+    sim_options base;
+    memory_config memory;
+    std::vector<sweep_axis> axes;
+    std::string metrics = "text";
+    std::string error;
+
+    for (int i = 3; i < argc; i++) {
+        std::string option = argv[i];
+        std::size_t equals = option.find('=');
+        std::string key = equals == std::string::npos ? "" : option.substr(2, equals - 2);
+        std::replace(key.begin(), key.end(), '-', '_');
+        bool sweeps = std::find(std::begin(SWEEP_KEYS), std::end(SWEEP_KEYS), key) !=
+                      std::end(SWEEP_KEYS);
+
+        bool ok = true;
+        if (option.rfind("--policy=", 0) == 0) {
+            ok = parse_policies(option.substr(9), policies, error);
+        } else if (option.rfind("--jobs=", 0) == 0) {
+            ok = parse_jobs(option.substr(7), workers);
+            if (!ok) error = "Invalid option: " + option;
+        } else if (option.rfind("--config=", 0) == 0) {
+            ok = load_sim_config(option.c_str() + 9, base, error);
+        } else if (sweeps && is_sim_option(option)) {
+            sweep_axis axis{key, {}};
+            ok = parse_sweep_values(option.substr(equals + 1), axis.values);
+            if (!ok) {
+                error = "Invalid range: " + option;
+            } else if (axis.values.size() == 1) {
+                error = set_sim_option(key, axis.values[0], base);
+                ok = error.empty();
+            } else {
+                axes.erase(std::remove_if(axes.begin(), axes.end(),
+                                          [&](const sweep_axis &other) { return other.key == key; }),
+                           axes.end());
+                axes.push_back(axis);
+            }
+        } else if (is_sim_option(option)) {
+            error = set_sim_option(option, base);
+            ok = error.empty();
+        } else if (option.rfind("--memory=", 0) == 0) {
+            ok = load_memory_config(option.c_str() + 9, memory, error);
+        } else if (option == "--metrics" || option == "--metrics=text") {
+            metrics = "text";
+        } else if (option == "--metrics=json") {
+            metrics = "json";
+        } else {
+            ok = false;
+            error = "Unknown option: " + option;
+        }
+        if (!ok) {
+            std::cerr << "Error: " << error << std::endl;
+            return -1;
+        }
+    }
+    if (policies.empty()) {
+        policies = {"EP", "RR", "EP_RR", "MLFQ"};
+    }
+
+    std::vector<sweep_point> points;
+    if (!make_sweep_grid(policies, axes, base, points, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return -1;
+    }
+
+    pcb_table processes;
+    if (!load_workload(input.c_str(), processes, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return -1;
+    }
+
+    run_sweep(processes, memory, points, workers);
+    mark_complete(points);
+    mark_pareto(points);
+
+    if (metrics == "json") {
+        print_sweep_json(std::cout, input, axes, points);
+    } else {
+        print_sweep(std::cout, input, axes, points);
+    }
+    return 0;
+}
+
+#endif  // SWEEP_101258593_HPP_
@@ -0,0 +1,191 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "simulator_api_101258593.hpp"
+
+// Regression tests of the engines through the Simulator library, run by
+// ctest. Every case runs under both engines, which must agree
+
+static int failures = 0;
+
+static void check(bool passed, const std::string &what) {
+    if (!passed) {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+//Keeps every transition of a run
+class recording_sink : public exec_sink {
+public:
+    void transition(unsigned int current_time, int PID,
+                    states old_state, states new_state,
+                    unsigned int cpu) override {
+        transitions.push_back({current_time, PID, cpu, old_state, new_state});
+    }
+    void finish() override {}
+
+    //PIDs that made the transition `from` -> `to`
+    std::set<int> pids(states from, states to) const {
+        std::set<int> found;
+        for (const sim_transition &t : transitions) {
+            if (t.old_state == from && t.new_state == to) found.insert(t.PID);
+        }
+        return found;
+    }
+
+    //Time of the first `from` -> `to` transition of `PID`, or UINT_MAX
+    unsigned int time_of(int PID, states from, states to) const {
+        for (const sim_transition &t : transitions) {
+            if (t.PID == PID && t.old_state == from && t.new_state == to) return t.time;
+        }
+        return UINT_MAX;
+    }
+
+    std::vector<sim_transition> transitions;
+};
+
+static bool same(const std::vector<sim_transition> &a, const std::vector<sim_transition> &b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); i++) {
+        if (a[i].time != b[i].time || a[i].PID != b[i].PID || a[i].cpu != b[i].cpu ||
+            a[i].old_state != b[i].old_state || a[i].new_state != b[i].new_state) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//A workload from input lines
+static pcb_table workload(const std::vector<std::string> &lines) {
+    pcb_table processes;
+    for (const std::string &line : lines) {
+        process_record process;
+        std::string error = parse_process_line(line.data(), line.data() + line.size(), process);
+        check(error.empty(), "parse '" + line + "': " + error);
+        processes.push_back(process);
+    }
+    return processes;
+}
+
+//Runs `processes` under both engines, checks they agree and returns the
+//event engine's transitions
+static recording_sink run(const std::string &name, const pcb_table &processes,
+                          const std::string &policy, sim_options options = sim_options()) {
+    recording_sink event, tick;
+    options.tick_engine = false;
+    Simulator event_run(processes, policy, memory_config(), options);
+    check(event_run.run(&event), name + ": " + event_run.error());
+    options.tick_engine = true;
+    Simulator tick_run(processes, policy, memory_config(), options);
+    check(tick_run.run(&tick), name + ": " + tick_run.error());
+    check(same(event.transitions, tick.transitions), name + ": the engines disagree");
+    return event;
+}
+
+//A process blocked on memory and one arriving after every other has
+//terminated both still run; one larger than every partition never does,
+//and does not keep the run going
+static void test_blocked_and_late_arrivals() {
+    pcb_table processes = workload({
+        "1, 40, 0, 100, 0, 0",          // the only 40 partition
+        "2, 40, 10, 20, 0, 0",          // blocked until 1 terminates
+        "3, 50, 0, 10, 0, 0",           // larger than every partition
+        "4, 5, 500, 10, 0, 0",          // arrives once the system is idle
+    });
+    for (const char *policy : {"EP", "RR", "EP_RR", "MLFQ"}) {
+        std::string name = std::string("blocked and late arrivals, ") + policy;
+        recording_sink sink = run(name, processes, policy);
+        check(sink.pids(RUNNING, TERMINATED) == std::set<int>({1, 2, 4}),
+              name + ": 1, 2 and 4 terminate");
+        check(sink.pids(NEW, READY).count(3) == 0, name + ": 3 is never admitted");
+        check(sink.time_of(2, NEW, READY) == 101, name + ": 2 is admitted after 1 frees memory");
+        check(sink.time_of(4, RUNNING, TERMINATED) == 510, name + ": 4 runs on arrival");
+    }
+
+    // --stop=admitted ends where the original simulators did
+    sim_options options;
+    options.stop_admitted = true;
+    recording_sink sink = run("--stop=admitted", processes, "EP", options);
+    check(sink.pids(RUNNING, TERMINATED) == std::set<int>({1}),
+          "--stop=admitted: the run ends with 1");
+}
+
+//A streamed input with an idle gap: the system runs dry while the next
+//line has not been written yet. The run must wait for it, not end
+static void test_stream_idle_gap() {
+    const std::vector<std::string> lines = {
+        "1, 10, 0, 10, 0, 0",
+        "2, 10, 50, 10, 0, 0",
+        "3, 10, 90, 5, 0, 0",
+    };
+    recording_sink whole = run("stream idle gap, loaded", workload(lines), "RR");
+
+    const std::string pipe = "tests_101258593_" + std::to_string(getpid()) + ".fifo";
+    check(mkfifo(pipe.c_str(), 0600) == 0, "stream idle gap: mkfifo " + pipe);
+    for (bool tick : {false, true}) {
+        std::string name = std::string("stream idle gap, ") + (tick ? "tick" : "event");
+        // the writer is slow after the first line, the run reaches t=10 first
+        std::thread writer([&]() {
+            std::ofstream out(pipe);
+            out << lines[0] << std::endl;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            out << lines[1] << "\n" << lines[2] << std::endl;
+        });
+        workload_stream stream(pipe);
+        check(stream.is_open(), name + ": open " + pipe);
+
+        sim_options options;
+        options.tick_engine = tick;
+        recording_sink streamed;
+        metrics_sink sink(&streamed);
+        std::unique_ptr<memory_manager> memory = make_memory_manager(memory_config());
+        run_simulation("RR", pcb_table(), *memory, sink, options, &stream);
+        writer.join();
+
+        check(stream.error().empty(), name + ": " + stream.error());
+        check(streamed.pids(RUNNING, TERMINATED) == std::set<int>({1, 2, 3}),
+              name + ": every process is read and run");
+        check(same(streamed.transitions, whole.transitions),
+              name + ": same run as the whole input");
+    }
+    std::remove(pipe.c_str());
+}
+
+//On two cores, a process that outranks both running ones preempts the
+//lower of them, never a core while the other runs a lower process
+static void test_no_inversion_across_cores() {
+    pcb_table processes = workload({
+        "1, 1, 0, 50, 0, 0, 1",
+        "2, 1, 0, 50, 0, 0, 5",
+        "3, 1, 10, 20, 0, 0, 0",        // outranks both once they run
+    });
+    sim_options options;
+    options.cpus = 2;
+    recording_sink sink = run("no inversion across cores", processes, "EP_RR", options);
+    check(sink.time_of(1, RUNNING, READY) == UINT_MAX,
+          "no inversion across cores: 1 is never preempted");
+    check(sink.time_of(2, RUNNING, READY) == 10,
+          "no inversion across cores: 3 preempts 2 on arrival");
+    check(sink.time_of(3, READY, RUNNING) == 10,
+          "no inversion across cores: 3 runs on arrival");
+}
+
+int main() {
+    test_blocked_and_late_arrivals();
+    test_stream_idle_gap();
+    test_no_inversion_across_cores();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All tests passed" << std::endl;
+    return 0;
+}